@@ -0,0 +1,343 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include "../src/render/basic.h"
+#include "../src/render/parallel.h"
+#include "../src/canvas.h"
+#include "../src/container/pngcont.h"
+#include "../src/container/ppmcont.h"
+#include "../src/container/asciicont.h"
+
+#include "scenes.h"
+
+// usage: benchmark [options] [scene...]
+//  -r <n>      repeat each stage n times and keep the fastest, default 3
+//  -o <dir>    directory of exported images, default 'out'
+//  -t <n>      render bands in n threads, 0 for all hardware threads,
+//              default 1, which renders without parallel render
+//  --json      print JSON instead of CSV
+//  --hp        enable high precision render
+//  --fast      enable fast math
+//  --exact     enable exact coverage
+//  --trace     redraw each scene once more with profiling, and write
+//              the trace to 'trace_<scene>.json' in the output directory
+//  --heatmap   same as '--trace', but write the count of SDF nodes
+//              evaluated per pixel to 'heatmap_<scene>.png'
+
+namespace {
+
+// allocation statistics, counted by global 'operator new'
+std::atomic<std::uint64_t> alloc_count(0), alloc_bytes(0);
+
+} // namespace
+
+// not inlined, otherwise GCC warns about 'free' on 'new'-ed pointers
+[[gnu::noinline]] void *operator new(std::size_t size) {
+    ++alloc_count;
+    alloc_bytes += size;
+    if (auto p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void *p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+using namespace cvf;
+using namespace cvf::bench;
+using namespace cvf::container;
+using namespace cvf::render;
+
+namespace {
+
+// scenes with more shapes are not timed shape by shape
+constexpr int kMaxPerShape = 16;
+
+struct Options {
+    int repeat = 3, threads = 1;
+    bool json = false, high_precision = false;
+    bool fast_math = false, exact_coverage = false;
+    bool trace = false, heatmap = false;
+    std::string out_dir = "out";
+    std::vector<std::string> scenes;
+};
+
+struct Record {
+    std::string scene, stage;
+    long long pixels;
+    // bytes produced by the stage, for MB/s
+    long long bytes;
+    double ns;
+    std::uint64_t allocs, alloc_bytes;
+};
+
+class Timer {
+public:
+    void Start() {
+        start_allocs_ = alloc_count;
+        start_alloc_bytes_ = alloc_bytes;
+        start_ = Clock::now();
+    }
+
+    // stop timer and keep the fastest run
+    void Stop() {
+        auto ns = std::chrono::duration<double, std::nano>(
+                Clock::now() - start_).count();
+        if (!runs_ || ns < ns_) {
+            ns_ = ns;
+            allocs_ = alloc_count - start_allocs_;
+            alloc_bytes_ = alloc_bytes - start_alloc_bytes_;
+        }
+        ++runs_;
+    }
+
+    Record GetRecord(const std::string &scene, const std::string &stage,
+            long long pixels, long long bytes) const {
+        return {scene, stage, pixels, bytes, ns_,
+                allocs_, alloc_bytes_};
+    }
+
+    double ns() const { return ns_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point start_;
+    int runs_ = 0;
+    double ns_ = 0;
+    std::uint64_t start_allocs_ = 0, start_alloc_bytes_ = 0;
+    std::uint64_t allocs_ = 0, alloc_bytes_ = 0;
+};
+
+RenderPtr MakeRender(const Options &opt) {
+    RenderPtr render;
+    if (opt.threads == 1) {
+        render = std::make_unique<BasicRender>();
+    }
+    else {
+        render = std::make_unique<ParallelRender>(opt.threads);
+    }
+    render->set_anti_aliasing(true);
+    render->set_high_precision(opt.high_precision);
+    render->set_fast_math(opt.fast_math);
+    render->set_exact_coverage(opt.exact_coverage);
+    return render;
+}
+
+// time a redraw of canvas with the specific shapes
+Timer TimeRedraw(const Options &opt, Canvas &canvas,
+        const shape::ShapeList &shapes) {
+    Timer timer;
+    canvas.ClearShape();
+    for (const auto &i : shapes) canvas.AddShape(i);
+    for (int i = 0; i < opt.repeat; ++i) {
+        timer.Start();
+        canvas.Redraw();
+        timer.Stop();
+    }
+    return timer;
+}
+
+// redraw with profiling, which is not timed, & write its results
+void ExportProfile(const Options &opt, const Scene &scene, Canvas &canvas) {
+    auto render = MakeRender(opt);
+    render->set_profiling(opt.trace);
+    if (opt.heatmap) render->set_heatmap(Render::Heatmap::Nodes);
+    const auto &profiler = render->profiler();
+    canvas.set_render(std::move(render));
+    canvas.Redraw();
+    if (opt.trace) {
+        auto path = opt.out_dir + "/trace_" + scene.name + ".json";
+        if (!profiler.ExportTrace(path.c_str())) {
+            std::fprintf(stderr, "failed to write %s\n", path.c_str());
+        }
+    }
+    if (opt.heatmap) {
+        auto path = opt.out_dir + "/heatmap_" + scene.name + ".png";
+        canvas.set_image_container(std::make_unique<PngContainer>());
+        canvas.ExportHeatmap(path.c_str());
+    }
+}
+
+// if the scene is chosen by command line
+bool IsChosen(const Options &opt, const char *name) {
+    if (opt.scenes.empty()) return true;
+    for (const auto &i : opt.scenes) {
+        if (i == name) return true;
+    }
+    return false;
+}
+
+void RunScene(const Options &opt, SceneBuilder builder,
+        std::vector<Record> &records) {
+    // construction
+    Timer build;
+    Scene scene;
+    for (int i = 0; i < opt.repeat; ++i) {
+        build.Start();
+        scene = builder();
+        build.Stop();
+    }
+    long long pixels = static_cast<long long>(scene.width) * scene.height;
+    auto frame_bytes = pixels * 3;
+    records.push_back(build.GetRecord(scene.name, "build", pixels, 0));
+    // render
+    Canvas canvas(scene.width, scene.height);
+    canvas.set_backcolor(scene.backcolor);
+    canvas.set_render(MakeRender(opt));
+    auto back = TimeRedraw(opt, canvas, {});
+    records.push_back(back.GetRecord(scene.name, "background",
+            pixels, frame_bytes));
+    if (static_cast<int>(scene.shapes.size()) <= kMaxPerShape) {
+        // cost of each shape, excluding the background
+        for (std::size_t i = 0; i < scene.shapes.size(); ++i) {
+            auto timer = TimeRedraw(opt, canvas, {scene.shapes[i]});
+            auto record = timer.GetRecord(scene.name,
+                    "shape" + std::to_string(i), pixels, frame_bytes);
+            record.ns = util::Max(record.ns - back.ns(), 0.);
+            records.push_back(record);
+        }
+    }
+    auto redraw = TimeRedraw(opt, canvas, scene.shapes);
+    records.push_back(redraw.GetRecord(scene.name, "redraw",
+            pixels, frame_bytes));
+    // export
+    struct {
+        const char *stage, *ext;
+        ImageContainerPtr (*make)();
+    } exporters[] = {
+        {"export_png", "png",
+                [] { return ImageContainerPtr(new PngContainer()); }},
+        {"export_ppm", "ppm", [] {
+            return ImageContainerPtr(new PpmContainer(
+                    PpmContainer::Format::PPM, true));
+        }},
+        {"export_ppm_ascii", "ascii.ppm",
+                [] { return ImageContainerPtr(new PpmContainer()); }},
+        {"export_ascii", "txt",
+                [] { return ImageContainerPtr(new AsciiContainer()); }},
+    };
+    for (const auto &i : exporters) {
+        auto path = opt.out_dir + "/bench_" + scene.name + "." + i.ext;
+        canvas.set_image_container(i.make());
+        Timer timer;
+        for (int j = 0; j < opt.repeat; ++j) {
+            timer.Start();
+            canvas.Export(path.c_str());
+            timer.Stop();
+        }
+        std::error_code ec;
+        auto size = std::filesystem::file_size(path, ec);
+        records.push_back(timer.GetRecord(scene.name, i.stage, pixels,
+                ec ? 0 : static_cast<long long>(size)));
+        std::filesystem::remove(path, ec);
+    }
+    if (opt.trace || opt.heatmap) ExportProfile(opt, scene, canvas);
+}
+
+void PrintCSV(const std::vector<Record> &records) {
+    std::printf("scene,stage,pixels,ns,ns_per_pixel,mb_per_s,"
+            "allocs,alloc_bytes\n");
+    for (const auto &i : records) {
+        std::printf("%s,%s,%lld,%.0f,%.3f,%.2f,%llu,%llu\n",
+                i.scene.c_str(), i.stage.c_str(), i.pixels, i.ns,
+                i.ns / i.pixels, i.ns > 0 ? i.bytes * 1e3 / i.ns : 0.,
+                static_cast<unsigned long long>(i.allocs),
+                static_cast<unsigned long long>(i.alloc_bytes));
+    }
+}
+
+void PrintJSON(const std::vector<Record> &records) {
+    std::printf("[\n");
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        const auto &r = records[i];
+        std::printf("  {\"scene\": \"%s\", \"stage\": \"%s\", "
+                "\"pixels\": %lld, \"ns\": %.0f, \"ns_per_pixel\": %.3f, "
+                "\"mb_per_s\": %.2f, \"allocs\": %llu, "
+                "\"alloc_bytes\": %llu}%s\n",
+                r.scene.c_str(), r.stage.c_str(), r.pixels, r.ns,
+                r.ns / r.pixels, r.ns > 0 ? r.bytes * 1e3 / r.ns : 0.,
+                static_cast<unsigned long long>(r.allocs),
+                static_cast<unsigned long long>(r.alloc_bytes),
+                i + 1 < records.size() ? "," : "");
+    }
+    std::printf("]\n");
+}
+
+bool ParseOptions(int argc, const char *argv[], Options &opt) {
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "-r") && i + 1 < argc) {
+            opt.repeat = util::Max(std::atoi(argv[++i]), 1);
+        }
+        else if (!std::strcmp(argv[i], "-o") && i + 1 < argc) {
+            opt.out_dir = argv[++i];
+        }
+        else if (!std::strcmp(argv[i], "-t") && i + 1 < argc) {
+            opt.threads = util::Max(std::atoi(argv[++i]), 0);
+        }
+        else if (!std::strcmp(argv[i], "--json")) {
+            opt.json = true;
+        }
+        else if (!std::strcmp(argv[i], "--hp")) {
+            opt.high_precision = true;
+        }
+        else if (!std::strcmp(argv[i], "--fast")) {
+            opt.fast_math = true;
+        }
+        else if (!std::strcmp(argv[i], "--exact")) {
+            opt.exact_coverage = true;
+        }
+        else if (!std::strcmp(argv[i], "--trace")) {
+            opt.trace = true;
+        }
+        else if (!std::strcmp(argv[i], "--heatmap")) {
+            opt.heatmap = true;
+        }
+        else if (argv[i][0] == '-') {
+            std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return false;
+        }
+        else {
+            opt.scenes.push_back(argv[i]);
+        }
+    }
+    for (const auto &i : opt.scenes) {
+        bool found = false;
+        for (const auto &scene : kScenes) found |= i == scene.name;
+        if (!found) {
+            std::fprintf(stderr, "unknown scene: %s\n", i.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    Options opt;
+    if (!ParseOptions(argc, argv, opt)) return 1;
+    std::error_code ec;
+    std::filesystem::create_directories(opt.out_dir, ec);
+    std::vector<Record> records;
+    // skip scenes before building them, some take seconds to build
+    for (const auto &i : kScenes) {
+        if (IsChosen(opt, i.name)) RunScene(opt, i.builder, records);
+    }
+    if (opt.json) {
+        PrintJSON(records);
+    }
+    else {
+        PrintCSV(records);
+    }
+    return 0;
+}
@@ -0,0 +1,273 @@
+#ifndef CANVASFLAT_BENCH_SCENES_H_
+#define CANVASFLAT_BENCH_SCENES_H_
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+
+#include "../src/color/color.h"
+#include "../src/shape/shape.h"
+#include "../src/shape/rectangle.h"
+#include "../src/shape/circle.h"
+#include "../src/shape/capsule.h"
+#include "../src/shape/squircle.h"
+#include "../src/shape/operation.h"
+#include "../src/shape/batch.h"
+#include "../src/shape/path.h"
+#include "../src/util/mathutil.h"
+
+// corpus of benchmark scenes
+// scenes are fully deterministic, random scenes use their own generator
+// so that the result does not depend on the standard library
+namespace cvf::bench {
+
+struct Scene {
+    const char *name;
+    int width, height;
+    color::Color backcolor;
+    shape::ShapeList shapes;
+};
+
+using SceneBuilder = Scene (*)();
+
+// 32-bit xorshift generator
+class Random {
+public:
+    Random(std::uint32_t seed) : state_(seed ? seed : 1) {}
+
+    std::uint32_t Next() {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return state_;
+    }
+
+    // uniform in [lo, hi)
+    float Next(float lo, float hi) {
+        return lo + (Next() >> 8) * (hi - lo) / (1 << 24);
+    }
+
+private:
+    std::uint32_t state_;
+};
+
+inline shape::ShapePtr MakeOp(shape::Operation::Opcode opcode,
+        const shape::ShapePtr &opr, float param) {
+    return std::make_shared<shape::Operation>(opcode, opr, param);
+}
+
+inline shape::ShapePtr MakeOp(shape::Operation::Opcode opcode,
+        const shape::ShapePtr &opr1, const shape::ShapePtr &opr2) {
+    return std::make_shared<shape::Operation>(opcode, opr1, opr2);
+}
+
+// the icon of 'test/weather.cpp', a typical small scene
+inline Scene BuildWeather() {
+    using namespace shape;
+    using color::Color;
+    using color::SolidColor;
+    using Op = Operation::Opcode;
+    Scene scene = {"weather", 1024, 1024, 0xFFFFFF, {}};
+    auto cx = scene.width / 2, cy = scene.height / 2;
+    auto round_r = cx * 0.35F, org_r = util::Min(cx, cy) * 3.F / 4.F;
+    auto r = org_r - round_r;
+    auto bg = MakeOp(Op::Round,
+            std::make_shared<Rectangle>(cx - r, cy - r, r * 2), round_r);
+    bg->set_color(Color(0x0278E2, 0x78EEFCU));
+    auto shadow = MakeOp(Op::OffsetY,
+            MakeOp(Op::Scale, MakeOp(Op::Blur, bg, 300), 1.2F), 30);
+    shadow->set_color(Color(0, 0.3F));
+    ShapePtr sun = std::make_shared<Circle>(cx - org_r * 0.35F,
+            cy - org_r * 0.2F, org_r * 0.37F);
+    sun->set_color(Color(0xFBC036, 0xF4E82DU));
+    ShapePtr c1 = std::make_shared<Capsule>(cx - org_r * 0.32F,
+            cy + org_r * 0.23F, cx + org_r * 0.38F, cy + org_r * 0.23F,
+            org_r * 0.23F);
+    ShapePtr c2 = std::make_shared<Circle>(cx + org_r * 0.38F,
+            cy + org_r * 0.16F, org_r * 0.3F);
+    ShapePtr c3 = std::make_shared<Circle>(cx, cy, org_r * 0.37F);
+    auto cloud = MakeOp(Op::Union, MakeOp(Op::Union, c1, c2), c3);
+    cloud->set_color(Color(SolidColor(0xFFFFFF, 0.75F),
+            SolidColor(0xFFFFFF, 0.97F)));
+    scene.shapes = {shadow, bg, sun, cloud};
+    return scene;
+}
+
+// a single shape built from a deep chain of operations
+inline Scene BuildDeepTree() {
+    using namespace shape;
+    using Op = Operation::Opcode;
+    Scene scene = {"deep_tree", 512, 512, 0x666666, {}};
+    auto cx = scene.width / 2.F, cy = scene.height / 2.F;
+    ShapePtr temp = std::make_shared<Squircle>(cx, cy, cx * 0.8F);
+    for (int i = 0; i < 48; ++i) {
+        switch (i % 4) {
+            case 0: temp = MakeOp(Op::Rotate, temp, util::PI / 48); break;
+            case 1: temp = MakeOp(Op::Scale, temp, 0.995F); break;
+            case 2: {
+                ShapePtr hole = std::make_shared<Circle>(
+                        cx + (i - 24) * 5, cy, 6);
+                temp = MakeOp(Op::Difference, temp, hole);
+                break;
+            }
+            default: temp = MakeOp(Op::Round, temp, 0.5F); break;
+        }
+    }
+    temp = MakeOp(Op::Outline, temp, 12);
+    temp->set_color(0xF0A030);
+    scene.shapes = {temp};
+    return scene;
+}
+
+// thousands of small independent shapes
+inline Scene BuildManyShapes() {
+    using namespace shape;
+    Scene scene = {"many_shapes", 1024, 1024, 0x202020, {}};
+    Random random(20180901);
+    for (int i = 0; i < 2000; ++i) {
+        auto x = random.Next(0, scene.width);
+        auto y = random.Next(0, scene.height);
+        auto r = random.Next(2, 14);
+        ShapePtr s;
+        if (i % 2) {
+            s = std::make_shared<Circle>(x, y, r);
+        }
+        else {
+            s = std::make_shared<Capsule>(x, y, x + random.Next(-30, 30),
+                    y + random.Next(-30, 30), r / 2);
+        }
+        s->set_color(color::Color(random.Next() & 0xFFFFFF, 0.8F));
+        scene.shapes.push_back(s);
+    }
+    return scene;
+}
+
+// large shapes filled with every kind of gradient
+inline Scene BuildGradients() {
+    using namespace shape;
+    using color::Color;
+    using color::SolidColor;
+    Scene scene = {"gradients", 1024, 1024,
+            Color(SolidColor(0x101040), SolidColor(0x401010)), {}};
+    ShapePtr linear = std::make_shared<Rectangle>(64, 64, 896, 384);
+    linear->set_color(Color(SolidColor(0xFF0000), SolidColor(0x0000FF),
+            util::PI / 6));
+    ShapePtr radial = std::make_shared<Circle>(512, 640, 320);
+    radial->set_color(Color(Color::ColorType::Radial,
+            SolidColor(0xFFFFFF, 0.9F), SolidColor(0x00FF00, 0.3F),
+            0, 1, 0));
+    ShapePtr func = std::make_shared<Squircle>(512, 512, 400);
+    func->set_color(Color([](float x, float y) {
+        return SolidColor(x * 255, y * 255, 128, 0.5F);
+    }));
+    scene.shapes = {linear, radial, func};
+    return scene;
+}
+
+// few shapes on a huge canvas, dominated by per-pixel overhead
+inline Scene BuildHugeCanvas() {
+    using namespace shape;
+    using Op = Operation::Opcode;
+    Scene scene = {"huge_canvas", 4096, 4096, 0xFFFFFF, {}};
+    ShapePtr rect = std::make_shared<Rectangle>(256, 256, 3584);
+    rect = MakeOp(Op::Round, rect, 512);
+    rect->set_color(0x0278E2);
+    ShapePtr circle = std::make_shared<Circle>(2048, 2048, 1200);
+    circle->set_color(color::Color(0xFFFFFF, 0.5F));
+    scene.shapes = {rect, circle};
+    return scene;
+}
+
+// blobs blended by smooth union, in a batch & by operations
+inline Scene BuildSmoothBlobs() {
+    using namespace shape;
+    using Op = Operation::Opcode;
+    Scene scene = {"smooth_blobs", 1024, 1024, 0x102030, {}};
+    Random random(20181024);
+    auto blobs = std::make_shared<CircleBatch>(24);
+    for (int i = 0; i < 300; ++i) {
+        blobs->Add(random.Next(64, 960), random.Next(64, 960),
+                random.Next(6, 20));
+    }
+    blobs->set_color(color::Color(0x40C0A0, 0.9F));
+    ShapePtr rect = std::make_shared<Rectangle>(312, 312, 400);
+    ShapePtr circle = std::make_shared<Circle>(712, 712, 160);
+    auto blend = std::make_shared<Operation>(Op::SmoothUnion, rect, circle,
+            96);
+    blend->set_color(color::Color(0xF0A040, 0.6F));
+    scene.shapes = {blobs, blend};
+    return scene;
+}
+
+// thousands of instances in circle & capsule batches
+inline Scene BuildBatches() {
+    using namespace shape;
+    Scene scene = {"batches", 1024, 1024, 0x181818, {}};
+    Random random(20181108);
+    auto circles = std::make_shared<CircleBatch>();
+    auto capsules = std::make_shared<CapsuleBatch>();
+    circles->Reserve(3000);
+    capsules->Reserve(3000);
+    for (int i = 0; i < 3000; ++i) {
+        auto x = random.Next(0, scene.width);
+        auto y = random.Next(0, scene.height);
+        circles->Add(x, y, random.Next(2, 10));
+        x = random.Next(0, scene.width);
+        y = random.Next(0, scene.height);
+        capsules->Add(x, y, x + random.Next(-30, 30),
+                y + random.Next(-30, 30), random.Next(1, 5));
+    }
+    circles->set_color(color::Color(0xF0C040, 0.8F));
+    capsules->set_color(color::Color(0x40A0F0, 0.8F));
+    scene.shapes = {circles, capsules};
+    return scene;
+}
+
+// glyph-like outlines of hundreds of lines & curves
+inline Scene BuildOutlines() {
+    using namespace shape;
+    Scene scene = {"outlines", 1024, 1024, 0xF8F8F0, {}};
+    Random random(20181101);
+    for (int i = 0; i < 16; ++i) {
+        auto cx = 128 + i % 4 * 256.F, cy = 128 + i / 4 * 256.F;
+        auto path = std::make_shared<Path>();
+        // wavy outer contour of curves
+        int waves = 96 + random.Next() % 96;
+        path->MoveTo(cx + 100, cy);
+        for (int j = 0; j < waves; ++j) {
+            auto a = 2 * util::PI * (j + 0.5F) / waves;
+            auto b = 2 * util::PI * (j + 1) / waves;
+            auto r = random.Next(80, 120);
+            path->QuadTo(cx + r * std::cos(a), cy + r * std::sin(a),
+                    cx + 100 * std::cos(b), cy + 100 * std::sin(b));
+        }
+        // inner hole of lines, in reverse direction
+        path->MoveTo(cx + 40, cy);
+        for (int j = 1; j <= 64; ++j) {
+            auto a = -2 * util::PI * j / 64;
+            path->LineTo(cx + 40 * std::cos(a), cy + 40 * std::sin(a));
+        }
+        path->Close();
+        path->set_color(color::Color(random.Next() & 0xFFFFFF, 0.9F));
+        scene.shapes.push_back(path);
+    }
+    return scene;
+}
+
+// builders with names of their scenes, so that scenes can be chosen
+// without being built
+struct SceneEntry {
+    const char *name;
+    SceneBuilder builder;
+};
+
+inline const SceneEntry kScenes[] = {
+    {"weather", BuildWeather}, {"deep_tree", BuildDeepTree},
+    {"many_shapes", BuildManyShapes}, {"gradients", BuildGradients},
+    {"huge_canvas", BuildHugeCanvas}, {"smooth_blobs", BuildSmoothBlobs},
+    {"batches", BuildBatches}, {"outlines", BuildOutlines},
+};
+
+} // namespace cvf::bench
+
+#endif // CANVASFLAT_BENCH_SCENES_H_
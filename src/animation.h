@@ -0,0 +1,199 @@
+#ifndef CANVASFLAT_ANIMATION_H_
+#define CANVASFLAT_ANIMATION_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <utility>
+
+#include "color/color.h"
+#include "color/format.h"
+#include "container/framesink.h"
+#include "render/render.h"
+#include "shape/shape.h"
+#include "shape/animated.h"
+#include "util/mathutil.h"
+
+namespace cvf {
+
+// renders frames of animated shapes, the last frame is kept in buffer,
+// & only areas covered by changed shapes in either frame are redrawn
+class Animation {
+public:
+    Animation(int width, int height)
+            : Animation(width, height, color::PixelFormat::RGB8) {}
+    Animation(int width, int height, color::PixelFormat format)
+            : width_(width), height_(height), format_(format),
+              frame_valid_(false) {
+        image_buffer_.resize(width_ * height_
+                * color::BytesPerPixel(format_));
+    }
+
+    // static shapes, call 'Invalidate' if they are modified
+    int AddShape(const shape::ShapePtr &shape) {
+        frame_valid_ = false;
+        shapes_.push_back(shape);
+        return shapes_.size() - 1;
+    }
+    // shapes updated at each frame
+    int AddShape(const shape::AnimatedShapePtr &shape) {
+        animated_.push_back({shape, shape::Rect(0, 0, -1, -1)});
+        return AddShape(shape::ShapePtr(shape));
+    }
+    void ClearShape() {
+        frame_valid_ = false;
+        shapes_.clear();
+        animated_.clear();
+    }
+
+    // redraw the whole frame next time
+    void Invalidate() { frame_valid_ = false; }
+
+    // render frame at 'time' into buffer
+    void RenderFrame(float time) {
+        dirty_.clear();
+        for (auto &&i : animated_) {
+            if (!i.shape->Update(time) && frame_valid_) continue;
+            // both the old & new area of shape must be redrawn
+            auto area = i.shape->GetDrawArea();
+            AddDirty(i.area);
+            AddDirty(area);
+            i.area = area;
+        }
+        if (!frame_valid_) {
+            dirty_.assign(1, shape::Rect(0, 0, width_ - 1, height_ - 1));
+        }
+        render_->ReadBuffer(image_buffer_.data(), width_, height_, format_);
+        for (const auto &rect : dirty_) {
+            render_->set_clip(rect);
+            render_->Redraw(backcolor_, shapes_);
+        }
+        render_->ResetClip();
+        frame_valid_ = true;
+    }
+
+    // render 'count' frames from time 'begin' with 'interval' between,
+    // each frame is written to sink by an encoder thread while the next
+    // frame is rendering, one thread serves all frames of the call
+    void Render(float begin, float interval, int count,
+            container::FrameSink &sink) {
+        // frames are handed over in 'encode_buffer_', 'pending' is the
+        // index of frame waiting in it, or -1 if the encoder is idle
+        std::mutex mutex;
+        std::condition_variable cond;
+        int pending = -1;
+        bool done = false;
+        std::thread encoder([&] {
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;) {
+                cond.wait(lock, [&] { return pending >= 0 || done; });
+                if (pending < 0) return;
+                auto index = pending;
+                lock.unlock();
+                sink.Write(index, encode_buffer_.data(), width_, height_,
+                        format_);
+                lock.lock();
+                pending = -1;
+                cond.notify_all();
+            }
+        });
+        for (int i = 0; i < count; ++i) {
+            RenderFrame(begin + i * interval);
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [&] { return pending < 0; });
+            CopyFrame();
+            pending = i;
+            cond.notify_all();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        cond.notify_all();
+        encoder.join();
+    }
+
+    void set_backcolor(const color::Color &backcolor) {
+        frame_valid_ = false;
+        backcolor_ = backcolor;
+    }
+    void set_render(render::RenderPtr render) {
+        frame_valid_ = false;
+        render_ = std::move(render);
+    }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    color::PixelFormat format() const { return format_; }
+    const color::Color8b *pixel() const { return image_buffer_.data(); }
+    // areas redrawn in last frame
+    const std::vector<shape::Rect> &dirty_rects() const { return dirty_; }
+
+private:
+    struct AnimatedEntry {
+        shape::AnimatedShapePtr shape;
+        // draw area of shape in last frame
+        shape::Rect area;
+    };
+
+    // add area to dirty rectangles, overlapping ones are merged
+    void AddDirty(shape::Rect rect) {
+        rect.left = util::Max(rect.left, 0);
+        rect.top = util::Max(rect.top, 0);
+        rect.right = util::Min(rect.right, width_ - 1);
+        rect.bottom = util::Min(rect.bottom, height_ - 1);
+        if (rect.left > rect.right || rect.top > rect.bottom) return;
+        for (std::size_t i = 0; i < dirty_.size();) {
+            const auto &r = dirty_[i];
+            if (r.left > rect.right || r.right < rect.left
+                    || r.top > rect.bottom || r.bottom < rect.top) {
+                ++i;
+                continue;
+            }
+            // merge & check others again
+            rect.left = util::Min(rect.left, r.left);
+            rect.top = util::Min(rect.top, r.top);
+            rect.right = util::Max(rect.right, r.right);
+            rect.bottom = util::Max(rect.bottom, r.bottom);
+            dirty_.erase(dirty_.begin() + i);
+            i = 0;
+        }
+        dirty_.push_back(rect);
+    }
+
+    // copy current frame to encode buffer, which holds the last frame,
+    // so only dirty areas are copied
+    void CopyFrame() {
+        if (encode_buffer_.size() != image_buffer_.size()) {
+            encode_buffer_ = image_buffer_;
+            return;
+        }
+        auto bpp = color::BytesPerPixel(format_);
+        for (const auto &rect : dirty_) {
+            auto len = (rect.right - rect.left + 1) * bpp;
+            for (int y = rect.top; y <= rect.bottom; ++y) {
+                auto offset = (y * width_ + rect.left) * bpp;
+                std::memcpy(encode_buffer_.data() + offset,
+                        image_buffer_.data() + offset, len);
+            }
+        }
+    }
+
+    using ImageBuffer = std::vector<color::Color8b>;
+
+    int width_, height_;
+    color::PixelFormat format_;
+    bool frame_valid_;
+    color::Color backcolor_;
+    shape::ShapeList shapes_;
+    std::vector<AnimatedEntry> animated_;
+    std::vector<shape::Rect> dirty_;
+    ImageBuffer image_buffer_, encode_buffer_;
+    render::RenderPtr render_;
+};
+
+} // namespace cvf
+
+#endif // CANVASFLAT_ANIMATION_H_
@@ -1,70 +1,235 @@
 #ifndef CANVASFLAT_CANVAS_H_
 #define CANVASFLAT_CANVAS_H_
 
+#include <cmath>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <vector>
 #include <utility>
+#include <ostream>
 
 #include "color/color.h"
+#include "color/format.h"
 #include "container/imgcontainer.h"
 #include "render/render.h"
+#include "render/mipmap.h"
+#include "render/preview.h"
+#include "render/tilecache.h"
 #include "shape/shape.h"
+#include "shape/layer.h"
+#include "shape/view.h"
 #include "util/mathutil.h"
+#include "util/allocator.h"
 
 namespace cvf {
 
 class Canvas {
 public:
-    Canvas(int width, int height) {
+    Canvas(int width, int height)
+            : format_(color::PixelFormat::RGB8), version_(0),
+              cleared_(false) {
+        set_size(width, height);
+    }
+    Canvas(int width, int height, color::PixelFormat format)
+            : format_(format), version_(0), cleared_(false) {
         set_size(width, height);
     }
 
     void Redraw() {
-        render_->ReadBuffer(image_buffer_.data(), width_, height_);
+        render_->ReadBuffer(image_buffer_.data(), width_, height_, format_);
+        // a new buffer is first touched by the render
+        if (!cleared_) {
+            render_->ClearBuffer();
+            cleared_ = true;
+        }
         render_->Redraw(backcolor_, shapes_);
     }
 
+    // size of buffer for 'region' rendered at 'scale'
+    static void GetRegionSize(const shape::Rect &region, float scale,
+            int &width, int &height) {
+        width = std::ceil((region.right - region.left + 1) * scale);
+        height = std::ceil((region.bottom - region.top + 1) * scale);
+    }
+
+    // render 'region' of canvas (inclusive) magnified by 'scale' into
+    // 'buffer', whose size is given by 'GetRegionSize', the image of
+    // canvas is not touched, results are cached by region, scale,
+    // settings of render & version of scene, see 'Invalidate'
+    void RenderRegion(const shape::Rect &region, float scale,
+            unsigned char *buffer) {
+        int width, height;
+        GetRegionSize(region, scale, width, height);
+        if (width <= 0 || height <= 0) return;
+        auto size = static_cast<std::size_t>(width) * height
+                * color::BytesPerPixel(format_);
+        render::TileKey key = {region, scale, version_,
+                render_->setting_bits()};
+        if (auto tile = tile_cache_.Find(key)) {
+            std::memcpy(buffer, tile, size);
+            return;
+        }
+        // see shapes through the view of region
+        float x0 = region.left, y0 = region.top;
+        region_shapes_.clear();
+        for (const auto &shape : shapes_) {
+            region_shapes_.push_back(MakeView(shape, x0, y0, scale));
+        }
+        // background gradients span the whole canvas
+        auto backcolor = backcolor_;
+        if (!backcolor_.is_solid()) {
+            float kx = width / scale / width_, ky = height / scale / height_;
+            float bx = x0 / width_, by = y0 / height_;
+            backcolor = color::Color::ColorFunction(
+                    [back = backcolor_, kx, ky, bx, by](float px, float py) {
+                        return back.GetColor(bx + px * kx, by + py * ky);
+                    });
+        }
+        render_->ReadBuffer(buffer, width, height, format_);
+        render_->Redraw(backcolor, region_shapes_);
+        tile_cache_.Insert(key, buffer, size);
+    }
+
+    // mark scene changed, required after modifying shapes in place
+    void Invalidate() { ++version_; }
+
     void Export(const char *path) {
         // reset the buffer info to prevent width & height changes
-        image_container_->ReadBuffer(pixel(), width_, height_);
+        ClearBuffer();
+        image_container_->ReadBuffer(pixel(), width_, height_, format_);
+        image_container_->Export(path);
+    }
+    void Export(std::ostream &os) {
+        ClearBuffer();
+        image_container_->ReadBuffer(pixel(), width_, height_, format_);
+        image_container_->Export(os);
+    }
+
+    // export the cost heatmap of last redraw, see 'Render::set_heatmap'
+    void ExportHeatmap(const char *path) { ExportHeatmap(path, 0); }
+    void ExportHeatmap(const char *path, int max_count) {
+        heatmap_buffer_.resize(static_cast<std::size_t>(width_) * height_ * 3);
+        render_->GetHeatmap(heatmap_buffer_.data(), max_count);
+        image_container_->ReadBuffer(heatmap_buffer_.data(),
+                width_, height_);
         image_container_->Export(path);
     }
 
+    // write a preview of 'columns' characters wide to stream,
+    // rendered without redrawing the image
+    void Preview(std::ostream &os, int columns) const {
+        render::AsciiPreview(columns).Render(width_, height_, backcolor_,
+                shapes_, os);
+    }
+
+    // export the image & 'count - 1' mipmaps halved from it, 'pattern' is
+    // a printf format with one integer conversion replaced by the width
+    // of each image, e.g. "out/icon_%d.png"
+    void ExportMipmaps(const char *pattern, int count) {
+        ClearBuffer();
+        mipmap_.Build(pixel(), width_, height_, format_, count);
+        std::vector<char> path;
+        for (int i = 0; i < mipmap_.level_count(); ++i) {
+            auto width = mipmap_.width(i);
+            path.resize(std::snprintf(nullptr, 0, pattern, width) + 1);
+            std::snprintf(path.data(), path.size(), pattern, width);
+            image_container_->ReadBuffer(mipmap_.pixel(i), width,
+                    mipmap_.height(i), format_);
+            image_container_->Export(path.data());
+        }
+    }
+
     int AddShape(const shape::ShapePtr &shape) {
+        ++version_;
         shapes_.push_back(shape);
         return shapes_.size() - 1;
     }
-    void ClearShape() { shapes_.clear(); }
+    void ClearShape() {
+        ++version_;
+        shapes_.clear();
+    }
 
     void set_size(int width, int height) {
+        ++version_;
         width_ = width;
         height_ = height;
-        image_buffer_.resize(width_ * height_ * 3);
+        // a new buffer is not touched until the first redraw,
+        // see 'Render::ClearBuffer'
+        image_buffer_ = ImageBuffer(static_cast<std::size_t>(width_)
+                * height_ * color::BytesPerPixel(format_));
+        cleared_ = false;
+    }
+    void set_format(color::PixelFormat format) {
+        format_ = format;
+        set_size(width_, height_);
     }
     void set_backcolor(const color::Color &backcolor) {
+        ++version_;
         backcolor_ = backcolor;
     }
     void set_image_container(container::ImageContainerPtr image_container) {
         image_container_ = std::move(image_container);
     }
     void set_render(render::RenderPtr render) {
+        ++version_;
         render_ = std::move(render);
     }
+    // maximum count of tiles cached by 'RenderRegion', 0 disables it
+    void set_tile_cache_size(int size) { tile_cache_.set_capacity(size); }
 
     int width() const { return width_; }
     int height() const { return height_; }
+    color::PixelFormat format() const { return format_; }
     const color::Color &backcolor() const { return backcolor_; }
     const color::Color8b *pixel() const { return image_buffer_.data(); }
     const shape::ShapeList &shapes() const { return shapes_; }
+    std::uint64_t version() const { return version_; }
 
 private:
-    using ImageBuffer = std::vector<color::Color8b>;
+    using ImageBuffer = std::vector<color::Color8b,
+            util::DefaultInitAllocator<color::Color8b>>;
+
+    // shape seen through the view of a region, pixels of a layer can
+    // not be magnified, so its shapes are drawn into a layer of views,
+    // keeping their own colors & the opacity of the layer
+    static shape::ShapePtr MakeView(const shape::ShapePtr &shape, float x0,
+            float y0, float scale) {
+        auto layer = std::dynamic_pointer_cast<shape::Layer>(shape);
+        if (scale == 1.F || !layer) {
+            return std::make_shared<shape::ViewShape>(shape, x0, y0, scale);
+        }
+        auto view = std::make_shared<shape::Layer>();
+        for (const auto &child : layer->shapes()) {
+            view->AddShape(MakeView(child, x0 - layer->offset_x(),
+                    y0 - layer->offset_y(), scale));
+        }
+        view->set_opacity(layer->opacity());
+        return view;
+    }
+
+    // zero the buffer if it has not been drawn
+    void ClearBuffer() {
+        if (cleared_) return;
+        std::memset(image_buffer_.data(), 0, image_buffer_.size());
+        cleared_ = true;
+    }
 
     int width_, height_;
+    color::PixelFormat format_;
+    std::uint64_t version_;
+    // if the buffer has been zeroed
+    bool cleared_;
     color::Color backcolor_;
     shape::ShapeList shapes_;
-    ImageBuffer image_buffer_;
+    ImageBuffer image_buffer_, heatmap_buffer_;
     container::ImageContainerPtr image_container_;
     render::RenderPtr render_;
+    render::Mipmap mipmap_;
+    render::TileCache tile_cache_;
+    shape::ShapeList region_shapes_;
 };
 
 } // namespace cvf
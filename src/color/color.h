@@ -7,57 +7,70 @@
 
 #include "solid.h"
 #include "../util/mathutil.h"
+#include "../util/fastmath.h"
 
 namespace cvf::color {
 
 class Color {
 public:
     using ColorFunction = std::function<SolidColor(float, float)>;
+    // fills 'count' colors of a row, the i-th color is at percent
+    // ((x + i) / width, y / height), called once per row
+    using ColorRowFunction = std::function<void(float x, float y,
+            float width, float height, int count, SolidColor *colors)>;
 
     enum class ColorType : char {
-        Solid, Linear, Radial, Functional
+        Solid, Linear, Radial, Functional, RowFunctional
     };
 
     Color() : color_type_(ColorType::Solid),
               color1_(nullptr), color2_(nullptr),
               start_(0.F), end_(0.F), radian_(0.F),
-              color_func_(nullptr) {}
+              dir_x_(std::cos(radian_)), dir_y_(std::sin(radian_)),
+              color_func_(nullptr), row_func_(nullptr) {}
     Color(std::nullptr_t)
             : color_type_(ColorType::Solid),
               color1_(nullptr), color2_(nullptr),
               start_(0.F), end_(0.F), radian_(0.F),
-              color_func_(nullptr) {}
+              dir_x_(std::cos(radian_)), dir_y_(std::sin(radian_)),
+              color_func_(nullptr), row_func_(nullptr) {}
     Color(SolidColor color)
             : color_type_(ColorType::Solid),
               color1_(color), color2_(nullptr),
               start_(0.F), end_(0.F), radian_(0.F),
-              color_func_(nullptr) {}
+              dir_x_(std::cos(radian_)), dir_y_(std::sin(radian_)),
+              color_func_(nullptr), row_func_(nullptr) {}
     Color(Color24b rgb)
             : color_type_(ColorType::Solid),
               color1_(rgb), color2_(nullptr),
               start_(0.F), end_(0.F), radian_(0.F),
-              color_func_(nullptr) {}
+              dir_x_(std::cos(radian_)), dir_y_(std::sin(radian_)),
+              color_func_(nullptr), row_func_(nullptr) {}
     Color(Color24b rgb, float alpha)
             : color_type_(ColorType::Solid),
               color1_(rgb, alpha), color2_(nullptr),
               start_(0.F), end_(0.F), radian_(0.F),
-              color_func_(nullptr) {}
+              dir_x_(std::cos(radian_)), dir_y_(std::sin(radian_)),
+              color_func_(nullptr), row_func_(nullptr) {}
     Color(SolidColor color1, SolidColor color2)
             : color_type_(ColorType::Linear),
               color1_(color1), color2_(color2),
               start_(0.F), end_(1.F), radian_(util::PI_2),
-              color_func_(nullptr) {}
+              dir_x_(std::cos(radian_)), dir_y_(std::sin(radian_)),
+              color_func_(nullptr), row_func_(nullptr) {}
     Color(Color24b rgb1, Color24b rgb2)
             : color_type_(ColorType::Linear),
               color1_(rgb1), color2_(rgb2),
               start_(0.F), end_(1.F), radian_(util::PI_2),
-              color_func_(nullptr) {}
+              dir_x_(std::cos(radian_)), dir_y_(std::sin(radian_)),
+              color_func_(nullptr), row_func_(nullptr) {}
     Color(SolidColor color1, SolidColor color2, float radian)
             : color_type_(ColorType::Linear),
               color1_(color1), color2_(color2),
               start_(0.F), end_(1.F),
               radian_(util::RadiansNormalize(radian)),
-              color_func_(nullptr) {}
+              dir_x_(std::cos(radian_)), dir_y_(std::sin(radian_)),
+              color_func_(nullptr), row_func_(nullptr) {}
     Color(ColorType color_type,
             SolidColor color1, SolidColor color2,
             float start, float end, float radian)
@@ -65,12 +78,20 @@ public:
               color1_(color1), color2_(color2),
               start_(start), end_(end),
               radian_(util::RadiansNormalize(radian)),
-              color_func_(nullptr) {}
+              dir_x_(std::cos(radian_)), dir_y_(std::sin(radian_)),
+              color_func_(nullptr), row_func_(nullptr) {}
     Color(ColorFunction color_func)
             : color_type_(ColorType::Functional),
               color1_(nullptr), color2_(nullptr),
               start_(0.F), end_(0.F), radian_(0.F),
-              color_func_(color_func) {}
+              dir_x_(1.F), dir_y_(0.F),
+              color_func_(color_func), row_func_(nullptr) {}
+    Color(ColorRowFunction row_func)
+            : color_type_(ColorType::RowFunctional),
+              color1_(nullptr), color2_(nullptr),
+              start_(0.F), end_(0.F), radian_(0.F),
+              dir_x_(1.F), dir_y_(0.F),
+              color_func_(nullptr), row_func_(row_func) {}
 
     SolidColor GetColor() const {
         return is_solid() ? color1_ : nullptr;
@@ -85,6 +106,11 @@ public:
             case ColorType::Functional: {
                 return color_func_(percent_x, percent_y);
             }
+            case ColorType::RowFunctional: {
+                SolidColor color;
+                row_func_(percent_x, percent_y, 1.F, 1.F, 1, &color);
+                return color;
+            }
             case ColorType::Linear: {
                 if (util::FloatEqual(radian_, 0)) {
                     percent = percent_x;
@@ -99,28 +125,96 @@ public:
                     percent = 1 - percent_y;
                 }
                 else {
-                    auto dx = percent_x - 0.5F, dy = percent_y - 0.5F;
-                    auto rho = std::sqrtf(dx * dx + dy * dy);
-                    float theta = std::atan2f(dy, dx);
-                    theta -= radian_;
-                    percent = rho * std::cosf(theta) + 0.5F;
+                    // projection on the direction of gradient
+                    percent = (percent_x - 0.5F) * dir_x_
+                            + (percent_y - 0.5F) * dir_y_ + 0.5F;
                 }
                 break;
             }
             case ColorType::Radial: {
-                auto dx = percent_x - 0.5F, dy = percent_y - 0.5F;
-                auto d = std::sqrtf(dx * dx + dy * dy);
-                percent = util::LinearMapping(d, 0, std::sqrtf(0.5), 0, 1);
+                percent = util::WithMath([&](auto math) {
+                    return GetRadialPercent(math, percent_x - 0.5F,
+                            percent_y - 0.5F);
+                });
                 break;
             }
         }
-        // gradient color
-        percent = util::LinearMapping(percent, start_, end_, 0, 1);
-        auto r = color1_.red * (1 - percent) + color2_.red * percent;
-        auto g = color1_.green * (1 - percent) + color2_.green * percent;
-        auto b = color1_.blue * (1 - percent) + color2_.blue * percent;
-        auto a = color1_.alpha * (1 - percent) + color2_.alpha * percent;
-        return SolidColor(r, g, b, a);
+        return GetGradient(percent);
+    }
+
+    // fill colors of a row, same as calling 'GetColor' with percent
+    // ((x + i) / width, y / height) for the i-th color, but gradients
+    // are evaluated without per-pixel dispatch, & functional colors
+    // cost at most one indirect call per pixel
+    void GetColorRow(float x, float y, float width, float height,
+            int count, SolidColor *colors) const {
+        auto py = y / height;
+        switch (color_type_) {
+            case ColorType::Solid: {
+                for (int i = 0; i < count; ++i) colors[i] = color1_;
+                break;
+            }
+            case ColorType::Functional: {
+                for (int i = 0; i < count; ++i) {
+                    colors[i] = color_func_((x + i) / width, py);
+                }
+                break;
+            }
+            case ColorType::RowFunctional: {
+                row_func_(x, y, width, height, count, colors);
+                break;
+            }
+            case ColorType::Linear: {
+                if (util::FloatEqual(radian_, util::PI_2)
+                        || util::FloatEqual(radian_, 3 * util::PI_2)) {
+                    // constant along the row
+                    auto color = GetColor(0.F, py);
+                    for (int i = 0; i < count; ++i) colors[i] = color;
+                }
+                else if (util::FloatEqual(radian_, 0)) {
+                    for (int i = 0; i < count; ++i) {
+                        colors[i] = GetGradient((x + i) / width);
+                    }
+                }
+                else if (util::FloatEqual(radian_, util::PI)) {
+                    for (int i = 0; i < count; ++i) {
+                        colors[i] = GetGradient(1 - (x + i) / width);
+                    }
+                }
+                else {
+                    auto base = (py - 0.5F) * dir_y_ + 0.5F;
+                    for (int i = 0; i < count; ++i) {
+                        auto px = (x + i) / width;
+                        colors[i] = GetGradient((px - 0.5F) * dir_x_ + base);
+                    }
+                }
+                break;
+            }
+            case ColorType::Radial: {
+                auto dy = py - 0.5F;
+                util::WithMath([&](auto math) {
+                    for (int i = 0; i < count; ++i) {
+                        auto dx = (x + i) / width - 0.5F;
+                        colors[i] = GetGradient(
+                                GetRadialPercent(math, dx, dy));
+                    }
+                });
+                break;
+            }
+        }
+    }
+
+    // adapt a per-pixel function to row function, unlike 'ColorFunction'
+    // the function is called directly & can be inlined into the row loop
+    template <typename Func>
+    static ColorRowFunction MakeRowFunction(Func func) {
+        return [func](float x, float y, float width, float height,
+                int count, SolidColor *colors) {
+            auto py = y / height;
+            for (int i = 0; i < count; ++i) {
+                colors[i] = func((x + i) / width, py);
+            }
+        };
     }
 
     Color &operator=(const SolidColor &solid) {
@@ -128,17 +222,38 @@ public:
         color1_ = solid;
         color2_ = nullptr;
         start_ = end_ = radian_ = 0.F;
+        dir_x_ = 1.F;
+        dir_y_ = 0.F;
         color_func_ = nullptr;
+        row_func_ = nullptr;
         return *this;
     }
 
     bool is_solid() const { return color_type_ == ColorType::Solid; }
 
 private:
+    template <typename Math>
+    static float GetRadialPercent(Math, float dx, float dy) {
+        auto d = Math::Sqrt(dx * dx + dy * dy);
+        return util::LinearMapping(d, 0, std::sqrtf(0.5), 0, 1);
+    }
+
+    SolidColor GetGradient(float percent) const {
+        percent = util::LinearMapping(percent, start_, end_, 0, 1);
+        auto r = color1_.red * (1 - percent) + color2_.red * percent;
+        auto g = color1_.green * (1 - percent) + color2_.green * percent;
+        auto b = color1_.blue * (1 - percent) + color2_.blue * percent;
+        auto a = color1_.alpha * (1 - percent) + color2_.alpha * percent;
+        return SolidColor(r, g, b, a);
+    }
+
     ColorType color_type_;
     SolidColor color1_, color2_;
     float start_, end_, radian_;
+    // unit vector of the direction of linear gradient
+    float dir_x_, dir_y_;
     ColorFunction color_func_;
+    ColorRowFunction row_func_;
 };
 
 } // namespace cvf::color
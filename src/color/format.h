@@ -0,0 +1,171 @@
+#ifndef CANVASFLAT_COLOR_FORMAT_H_
+#define CANVASFLAT_COLOR_FORMAT_H_
+
+#include <cstdint>
+#include <cstring>
+
+#include "solid.h"
+
+namespace cvf::color {
+
+enum class PixelFormat : char {
+    RGB8,          // 24-bit RGB, no alpha channel
+    RGBA8,         // 32-bit RGBA, straight alpha
+    PremulRGBA8,   // 32-bit RGBA, premultiplied alpha
+    RGBA16,        // 64-bit RGBA, straight alpha, native endian
+    RGBAF          // 128-bit RGBA, straight alpha, 32-bit float
+};
+
+inline int BytesPerPixel(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::RGB8: return 3;
+        case PixelFormat::RGBA8: case PixelFormat::PremulRGBA8: return 4;
+        case PixelFormat::RGBA16: return 8;
+        case PixelFormat::RGBAF: return 16;
+    }
+    return 3;
+}
+
+inline bool HasAlpha(PixelFormat format) {
+    return format != PixelFormat::RGB8;
+}
+
+// 32-bit packed RGBA8 pixel, channels are kept in memory order
+// so that a pixel can be loaded or stored with a single 32-bit access
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr int kRedShift = 24, kGreenShift = 16,
+              kBlueShift = 8, kAlphaShift = 0;
+#else
+constexpr int kRedShift = 0, kGreenShift = 8,
+              kBlueShift = 16, kAlphaShift = 24;
+#endif
+
+inline std::uint32_t LoadPixel32(const unsigned char *p) {
+    std::uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline void StorePixel32(unsigned char *p, std::uint32_t v) {
+    std::memcpy(p, &v, sizeof(v));
+}
+
+inline std::uint32_t PackPixel32(Color8b r, Color8b g, Color8b b,
+        Color8b a) {
+    return (static_cast<std::uint32_t>(r) << kRedShift)
+            | (static_cast<std::uint32_t>(g) << kGreenShift)
+            | (static_cast<std::uint32_t>(b) << kBlueShift)
+            | (static_cast<std::uint32_t>(a) << kAlphaShift);
+}
+
+inline Color8b ClampTo8b(float value) {
+    return value >= 255.F ? 255 : (value > 0.F ? value : 0);
+}
+
+inline Color8b AlphaTo8b(float alpha) {
+    return static_cast<Color8b>(alpha * 255.F + 0.5F);
+}
+
+// read a pixel of any format as 8-bit RGB with float alpha
+inline SolidColor ReadPixel(const unsigned char *p, PixelFormat format) {
+    switch (format) {
+        case PixelFormat::RGB8: {
+            return SolidColor(p[0], p[1], p[2]);
+        }
+        case PixelFormat::RGBA8: {
+            return SolidColor(p[0], p[1], p[2], p[3] / 255.F);
+        }
+        case PixelFormat::PremulRGBA8: {
+            if (!p[3]) return SolidColor();
+            auto k = 255.F / p[3];
+            auto r = ClampTo8b(p[0] * k), g = ClampTo8b(p[1] * k);
+            auto b = ClampTo8b(p[2] * k);
+            return SolidColor(r, g, b, p[3] / 255.F);
+        }
+        case PixelFormat::RGBA16: {
+            std::uint16_t v[4];
+            std::memcpy(v, p, sizeof(v));
+            return SolidColor(v[0] >> 8, v[1] >> 8, v[2] >> 8,
+                    v[3] / 65535.F);
+        }
+        case PixelFormat::RGBAF: {
+            float v[4];
+            std::memcpy(v, p, sizeof(v));
+            return SolidColor(ClampTo8b(v[0] * 255.F + 0.5F),
+                    ClampTo8b(v[1] * 255.F + 0.5F),
+                    ClampTo8b(v[2] * 255.F + 0.5F), v[3]);
+        }
+    }
+    return SolidColor();
+}
+
+// write a pixel of any format, alpha is ignored by 'RGB8'
+inline void WritePixel(unsigned char *p, PixelFormat format,
+        const SolidColor &color) {
+    switch (format) {
+        case PixelFormat::RGB8: {
+            p[0] = color.red;
+            p[1] = color.green;
+            p[2] = color.blue;
+            break;
+        }
+        case PixelFormat::RGBA8: {
+            StorePixel32(p, PackPixel32(color.red, color.green,
+                    color.blue, AlphaTo8b(color.alpha)));
+            break;
+        }
+        case PixelFormat::PremulRGBA8: {
+            auto a = color.alpha;
+            StorePixel32(p, PackPixel32(color.red * a + 0.5F,
+                    color.green * a + 0.5F, color.blue * a + 0.5F,
+                    AlphaTo8b(a)));
+            break;
+        }
+        case PixelFormat::RGBA16: {
+            std::uint16_t v[4] = {
+                static_cast<std::uint16_t>(color.red * 257),
+                static_cast<std::uint16_t>(color.green * 257),
+                static_cast<std::uint16_t>(color.blue * 257),
+                static_cast<std::uint16_t>(color.alpha * 65535.F + 0.5F),
+            };
+            std::memcpy(p, v, sizeof(v));
+            break;
+        }
+        case PixelFormat::RGBAF: {
+            float v[4] = {
+                color.red / 255.F, color.green / 255.F,
+                color.blue / 255.F, color.alpha,
+            };
+            std::memcpy(p, v, sizeof(v));
+            break;
+        }
+    }
+}
+
+// convert 'count' pixels between two formats
+inline void ConvertPixels(const unsigned char *src, PixelFormat src_format,
+        unsigned char *dst, PixelFormat dst_format, int count) {
+    auto src_bpp = BytesPerPixel(src_format);
+    auto dst_bpp = BytesPerPixel(dst_format);
+    if (src_format == dst_format) {
+        std::memcpy(dst, src, count * src_bpp);
+    }
+    else if (src_format == PixelFormat::RGBA8
+            && dst_format == PixelFormat::RGB8) {
+        // fast path, just drop the alpha channel
+        for (int i = 0; i < count; ++i, src += 4, dst += 3) {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+    }
+    else {
+        for (int i = 0; i < count; ++i, src += src_bpp, dst += dst_bpp) {
+            WritePixel(dst, dst_format, ReadPixel(src, src_format));
+        }
+    }
+}
+
+} // namespace cvf::color
+
+#endif // CANVASFLAT_COLOR_FORMAT_H_
@@ -0,0 +1,61 @@
+#ifndef CANVASFLAT_COLOR_GAMMA_H_
+#define CANVASFLAT_COLOR_GAMMA_H_
+
+#include <cmath>
+
+#include "solid.h"
+
+namespace cvf::color {
+
+// conversion between sRGB encoded 8-bit values and linear light,
+// both directions are table driven so that they can be used per pixel
+
+inline float SrgbDecode(float v) {
+    return v <= 0.04045F ? v / 12.92F
+            : std::pow((v + 0.055F) / 1.055F, 2.4F);
+}
+
+inline float SrgbEncode(float v) {
+    return v <= 0.0031308F ? v * 12.92F
+            : 1.055F * std::pow(v, 1.F / 2.4F) - 0.055F;
+}
+
+class GammaTable {
+public:
+    // resolution of the linear -> sRGB table
+    static constexpr int kEncodeSize = 4096;
+
+    static const GammaTable &Get() {
+        static GammaTable table;
+        return table;
+    }
+
+    // 8-bit sRGB -> linear light in [0, 1]
+    float ToLinear(Color8b v) const { return decode_[v]; }
+
+    // linear light in [0, 1] -> sRGB in [0, 1], interpolated between
+    // entries, a step of table is almost a level of 8-bit in shadows
+    float ToSrgb(float v) const {
+        auto f = v * (kEncodeSize - 1);
+        f = f > 0.F ? (f < kEncodeSize - 1 ? f : kEncodeSize - 1) : 0.F;
+        int i = f;
+        i = i < kEncodeSize - 2 ? i : kEncodeSize - 2;
+        return encode_[i] + (encode_[i + 1] - encode_[i]) * (f - i);
+    }
+
+private:
+    GammaTable() {
+        for (int i = 0; i < 256; ++i) decode_[i] = SrgbDecode(i / 255.F);
+        for (int i = 0; i < kEncodeSize; ++i) {
+            encode_[i] = SrgbEncode(static_cast<float>(i)
+                    / (kEncodeSize - 1));
+        }
+    }
+
+    float decode_[256];
+    float encode_[kEncodeSize];
+};
+
+} // namespace cvf::color
+
+#endif // CANVASFLAT_COLOR_GAMMA_H_
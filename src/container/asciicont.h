@@ -2,16 +2,30 @@
 #define CANVASFLAT_CONTAINER_ASCIICONT_H_
 
 #include "imgcontainer.h"
-#include "../util/mathutil.h"
+#include "../color/solid.h"
 
 namespace cvf::container {
 
+// characters from dark to light
+constexpr char kAsciiRamp[] = "$@B%8&WM#*oahkbdpqwmZO0QLC"
+        "JUYXzcvunxrjft/\\|()1{}[]?-_+~<>i!lI;:,\"^`'. ";
+constexpr int kAsciiRampSize = sizeof(kAsciiRamp) - 1;
+
+// luma in [0, 255], BT.709 weights in 8-bit fixed point
+inline int GetLuma(color::Color8b r, color::Color8b g, color::Color8b b) {
+    return (54 * r + 183 * g + 19 * b) >> 8;
+}
+
+inline char GetASCII(int luma) {
+    return kAsciiRamp[luma * (kAsciiRampSize - 1) / 255];
+}
+
 class AsciiContainer : public ImageContainer {
 public:
     AsciiContainer() : ImageContainer() {}
 
 protected:
-    void ExportStream(std::ofstream &ofs) override {
+    void ExportStream(std::ostream &ofs) override {
         for (int y = 0; y + 1 < height_; y += 2) {
             for (int x = 0; x < width_; ++x) {
                 ofs.put(GetASCII(x, y));
@@ -21,25 +35,13 @@ protected:
     }
 
 private:
-    const int grayscale_count = 70;
-    const char *ascii_grayscale = "$@B%8&WM#*oahkbdpqwmZO0QLC"
-            "JUYXzcvunxrjft/\\|()1{}[]?-_+~<>i!lI;:,\"^`'. ";
-
+    // average luma of two pixels in a column
     char GetASCII(int x, int y) {
-        const auto cr = 0.2126F, cg = 0.7152F, cb = 0.0722F;
-        int pos[] = {
-            (y * width_ + x) * 3,
-            ((y + 1) * width_ + x) * 3,
-            // ((y + 2) * width_ + x) * 3,
-        };
-        int gray = 0;
-        for (const auto &i : pos) {
-            gray += buffer_[i] * cr;
-            gray += buffer_[i + 1] * cg;
-            gray += buffer_[i + 2] * cb;
-        }
-        int i = util::LinearMapping(gray, 0, 255 * 2, 0, grayscale_count);
-        return ascii_grayscale[i];
+        auto p0 = buffer_ + (y * width_ + x) * 3;
+        auto p1 = p0 + width_ * 3;
+        auto luma = GetLuma(p0[0], p0[1], p0[2])
+                + GetLuma(p1[0], p1[1], p1[2]);
+        return container::GetASCII(luma / 2);
     }
 };
 
@@ -0,0 +1,80 @@
+#ifndef CANVASFLAT_CONTAINER_FILEBUF_H_
+#define CANVASFLAT_CONTAINER_FILEBUF_H_
+
+#include <memory>
+#include <streambuf>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace cvf::container {
+
+// output buffer of files, the buffer is allocated once & reused by
+// every file opened later, so exporting does not allocate
+class FileBuffer : public std::streambuf {
+public:
+    FileBuffer() : fd_(-1), buffer_(new char[kBufferSize]) {
+        setp(buffer_.get(), buffer_.get() + kBufferSize);
+    }
+    ~FileBuffer() { Close(); }
+
+    FileBuffer(const FileBuffer &) = delete;
+    FileBuffer &operator=(const FileBuffer &) = delete;
+
+    // create or truncate file for writing
+    bool Open(const char *path) {
+        Close();
+        fd_ = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        return fd_ >= 0;
+    }
+
+    // flush & close, returns false if any write failed
+    bool Close() {
+        if (fd_ < 0) return true;
+        auto ret = Flush();
+        ret = !close(fd_) && ret;
+        fd_ = -1;
+        return ret;
+    }
+
+    bool is_open() const { return fd_ >= 0; }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!Flush()) return traits_type::eof();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override { return Flush() ? 0 : -1; }
+
+private:
+    static constexpr int kBufferSize = 64 * 1024;
+
+    // write buffered bytes to file
+    bool Flush() {
+        auto p = pbase();
+        bool ok = fd_ >= 0;
+        while (ok && p < pptr()) {
+            auto ret = write(fd_, p, pptr() - p);
+            if (ret > 0) {
+                p += ret;
+            }
+            else {
+                ok = false;
+            }
+        }
+        setp(buffer_.get(), buffer_.get() + kBufferSize);
+        return ok;
+    }
+
+    int fd_;
+    std::unique_ptr<char[]> buffer_;
+};
+
+} // namespace cvf::container
+
+#endif // CANVASFLAT_CONTAINER_FILEBUF_H_
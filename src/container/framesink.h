@@ -0,0 +1,86 @@
+#ifndef CANVASFLAT_CONTAINER_FRAMESINK_H_
+#define CANVASFLAT_CONTAINER_FRAMESINK_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+
+#include "imgcontainer.h"
+#include "../color/format.h"
+
+namespace cvf::container {
+
+// receiver of rendered frames of an animation
+// 'Write' may be called from another thread than the renderer,
+// but never concurrently
+class FrameSink {
+public:
+    virtual ~FrameSink() = default;
+
+    virtual void Write(int index, const unsigned char *buffer,
+            int width, int height, color::PixelFormat format) = 0;
+};
+
+// export frames to numbered files, 'pattern' is a printf format
+// with one integer conversion, e.g. "out/frame%04d.png"
+class SequenceSink : public FrameSink {
+public:
+    SequenceSink(const std::string &pattern, ImageContainerPtr container)
+            : pattern_(pattern), container_(std::move(container)) {}
+
+    void Write(int index, const unsigned char *buffer,
+            int width, int height, color::PixelFormat format) override {
+        auto len = std::snprintf(nullptr, 0, pattern_.c_str(), index);
+        path_.resize(len + 1);
+        std::snprintf(path_.data(), path_.size(), pattern_.c_str(), index);
+        container_->ReadBuffer(buffer, width, height, format);
+        container_->Export(path_.data());
+    }
+
+private:
+    std::string pattern_;
+    ImageContainerPtr container_;
+    std::vector<char> path_;
+};
+
+// keep copies of frames in memory
+class MemorySink : public FrameSink {
+public:
+    MemorySink()
+            : width_(0), height_(0), format_(color::PixelFormat::RGB8) {}
+
+    void Write(int index, const unsigned char *buffer,
+            int width, int height, color::PixelFormat format) override {
+        if (static_cast<int>(frames_.size()) <= index) {
+            frames_.resize(index + 1);
+        }
+        auto size = width * height * color::BytesPerPixel(format);
+        frames_[index].assign(buffer, buffer + size);
+        width_ = width;
+        height_ = height;
+        format_ = format;
+    }
+
+    void Clear() { frames_.clear(); }
+
+    int frame_count() const { return frames_.size(); }
+    const std::vector<unsigned char> &frame(int index) const {
+        return frames_[index];
+    }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    color::PixelFormat format() const { return format_; }
+
+private:
+    std::vector<std::vector<unsigned char>> frames_;
+    int width_, height_;
+    color::PixelFormat format_;
+};
+
+using FrameSinkPtr = std::unique_ptr<FrameSink>;
+
+} // namespace cvf::container
+
+#endif // CANVASFLAT_CONTAINER_FRAMESINK_H_
@@ -1,8 +1,12 @@
 #ifndef CANVASFLAT_CONTAINER_IMGCONTAINER_H_
 #define CANVASFLAT_CONTAINER_IMGCONTAINER_H_
 
-#include <fstream>
+#include <ostream>
 #include <memory>
+#include <vector>
+
+#include "filebuf.h"
+#include "../color/format.h"
 
 namespace cvf::container {
 
@@ -11,25 +15,59 @@ public:
     virtual ~ImageContainer() = default;
 
     void ReadBuffer(const unsigned char *buffer, int width, int height) {
-        buffer_ = buffer;
+        ReadBuffer(buffer, width, height, color::PixelFormat::RGB8);
+    }
+    // buffers of other formats are converted to 'RGB8', or to 'RGBA8'
+    // if the container supports alpha channel
+    void ReadBuffer(const unsigned char *buffer, int width, int height,
+            color::PixelFormat format) {
         width_ = width;
         height_ = height;
+        format_ = alpha_support_ && color::HasAlpha(format)
+                ? color::PixelFormat::RGBA8 : color::PixelFormat::RGB8;
+        if (format == format_) {
+            buffer_ = buffer;
+        }
+        else {
+            converted_.resize(width * height
+                    * color::BytesPerPixel(format_));
+            color::ConvertPixels(buffer, format, converted_.data(),
+                    format_, width * height);
+            buffer_ = converted_.data();
+        }
     }
 
+    // the file buffer & stream are reused by every export
     void Export(const char *path) {
-        std::ofstream ofs(path, std::ios::binary);
-        if (ofs.is_open()) {
-            ExportStream(ofs);
+        if (file_.Open(path)) {
+            file_stream_.clear();
+            ExportStream(file_stream_);
+            file_.Close();
         }
     }
 
+    // export to any stream, e.g. memory buffer or socket
+    void Export(std::ostream &os) { ExportStream(os); }
+
 protected:
-    ImageContainer() : buffer_(nullptr), width_(0), height_(0) {}
+    ImageContainer() : ImageContainer(false) {}
+    ImageContainer(bool alpha_support)
+            : buffer_(nullptr), width_(0), height_(0),
+              format_(color::PixelFormat::RGB8),
+              alpha_support_(alpha_support), file_stream_(&file_) {}
 
-    virtual void ExportStream(std::ofstream &ofs) = 0;
+    virtual void ExportStream(std::ostream &ofs) = 0;
 
     const unsigned char *buffer_;
     int width_, height_;
+    // either 'RGB8' or 'RGBA8'
+    color::PixelFormat format_;
+
+private:
+    bool alpha_support_;
+    std::vector<unsigned char> converted_;
+    FileBuffer file_;
+    std::ostream file_stream_;
 };
 
 using ImageContainerPtr = std::unique_ptr<ImageContainer>;
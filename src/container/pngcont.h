@@ -3,7 +3,7 @@
 
 #include "imgcontainer.h"
 
-#define SVPNG_OUTPUT std::ofstream &ofs
+#define SVPNG_OUTPUT std::ostream &ofs
 #define SVPNG_PUT(u) ofs.put(u)
 #include "png/svpng.inc"
 
@@ -11,12 +11,13 @@ namespace cvf::container {
 
 class PngContainer : public ImageContainer {
 public:
-    PngContainer() : ImageContainer() {}
+    PngContainer() : ImageContainer(true) {}
 
 protected:
-    void ExportStream(std::ofstream &ofs) override {
+    void ExportStream(std::ostream &ofs) override {
         if (buffer_ && width_ && height_) {
-            svpng(ofs, width_, height_, buffer_, false);
+            svpng(ofs, width_, height_, buffer_,
+                    format_ == color::PixelFormat::RGBA8);
         }
     }
 };
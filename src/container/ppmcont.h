@@ -13,13 +13,13 @@ public:
         PPM    // Portable Pixel Map, color
     };
 
-    PpmContainer() : format_(Format::PPM), binary_(false) {}
-    PpmContainer(Format format) : format_(format), binary_(false) {}
+    PpmContainer() : ppm_format_(Format::PPM), binary_(false) {}
+    PpmContainer(Format format) : ppm_format_(format), binary_(false) {}
     PpmContainer(Format format, bool binary)
-            : format_(format), binary_(binary) {}
+            : ppm_format_(format), binary_(binary) {}
 
 protected:
-    void ExportStream(std::ofstream &ofs) override {
+    void ExportStream(std::ostream &ofs) override {
         ofs.sync_with_stdio(false);
         WriteHeader(ofs);
         if (binary_) {
@@ -72,9 +72,9 @@ private:
         return threshold;
     }
 
-    void WriteHeader(std::ofstream &ofs) {
+    void WriteHeader(std::ostream &ofs) {
         ofs.put('P');
-        switch (format_) {
+        switch (ppm_format_) {
             case Format::PBM: {
                 ofs.put('1' + (binary_ ? 3 : 0));
                 ofs << '\n' << width_ << ' ' << height_ << '\n';
@@ -93,8 +93,8 @@ private:
         }
     }
 
-    void WriteBodyASCII(std::ofstream &ofs) {
-        switch (format_) {
+    void WriteBodyASCII(std::ostream &ofs) {
+        switch (ppm_format_) {
             case Format::PBM: {
                 auto threshold = GetOtsuThreshold();
                 for (int y = 0; y < height_; ++y) {
@@ -131,8 +131,8 @@ private:
         }
     }
 
-    void WriteBodyBinary(std::ofstream &ofs) {
-        switch (format_) {
+    void WriteBodyBinary(std::ostream &ofs) {
+        switch (ppm_format_) {
             case Format::PBM: {
                 auto threshold = GetOtsuThreshold();
                 char temp_byte = 0, cur_pos = 7;
@@ -172,7 +172,7 @@ private:
         }
     }
 
-    Format format_;
+    Format ppm_format_;
     bool binary_;
 };
 
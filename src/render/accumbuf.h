@@ -0,0 +1,167 @@
+#ifndef CANVASFLAT_RENDER_ACCUMBUF_H_
+#define CANVASFLAT_RENDER_ACCUMBUF_H_
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#include "../color/solid.h"
+#include "../color/format.h"
+#include "../color/gamma.h"
+#include "../util/allocator.h"
+
+namespace cvf::render {
+
+// high precision render target
+// channels are stored as separate float planes (structure of arrays)
+// in linear light with premultiplied alpha, the result is quantized
+// and gamma encoded only once by 'Resolve'
+// planes are not zeroed when resized, every pixel must be filled
+// before it's blended
+class AccumBuffer {
+public:
+    // scratch rows of 'Resolve', threads resolving different rows
+    // at the same time must use their own scratch
+    struct Scratch {
+        std::vector<float> row[4];
+    };
+
+    AccumBuffer() : width_(0), height_(0) {}
+
+    void Resize(int width, int height) {
+        width_ = width;
+        height_ = height;
+        auto size = width * height;
+        red_.resize(size);
+        green_.resize(size);
+        blue_.resize(size);
+        alpha_.resize(size);
+    }
+
+    void Fill(int x, int y, const color::SolidColor &rgba, float alpha) {
+        const auto &gamma = color::GammaTable::Get();
+        auto i = y * width_ + x;
+        red_[i] = gamma.ToLinear(rgba.red) * alpha;
+        green_[i] = gamma.ToLinear(rgba.green) * alpha;
+        blue_[i] = gamma.ToLinear(rgba.blue) * alpha;
+        alpha_[i] = alpha;
+    }
+
+    void Blend(int x, int y, const color::SolidColor &rgba, float alpha) {
+        const auto &gamma = color::GammaTable::Get();
+        auto i = y * width_ + x;
+        auto kd = 1 - alpha;
+        red_[i] = gamma.ToLinear(rgba.red) * alpha + red_[i] * kd;
+        green_[i] = gamma.ToLinear(rgba.green) * alpha + green_[i] * kd;
+        blue_[i] = gamma.ToLinear(rgba.blue) * alpha + blue_[i] * kd;
+        alpha_[i] = alpha + alpha_[i] * kd;
+    }
+
+    // quantize & gamma encode rows [top, bottom] into buffer,
+    // 8-bit formats are dithered with a 4x4 ordered dither matrix
+    void Resolve(unsigned char *buffer, color::PixelFormat format,
+            int top, int bottom) {
+        Resolve(buffer, format, 0, top, width_ - 1, bottom);
+    }
+    // resolve columns [left, right] of rows [top, bottom] only
+    void Resolve(unsigned char *buffer, color::PixelFormat format,
+            int left, int top, int right, int bottom) {
+        Resolve(buffer, format, left, top, right, bottom, scratch_);
+    }
+    void Resolve(unsigned char *buffer, color::PixelFormat format,
+            int left, int top, int right, int bottom, Scratch &scratch) {
+        using color::PixelFormat;
+        const auto &gamma = color::GammaTable::Get();
+        auto premul = format == PixelFormat::PremulRGBA8;
+        auto bpp = color::BytesPerPixel(format);
+        for (auto &&i : scratch.row) {
+            if (static_cast<int>(i.size()) < width_) i.resize(width_);
+        }
+        auto r = scratch.row[0].data(), g = scratch.row[1].data();
+        auto b = scratch.row[2].data(), a = scratch.row[3].data();
+        for (int y = top; y <= bottom; ++y) {
+            auto base = y * width_;
+            // unpremultiply & encode, SoA rows keep this pass branch free,
+            // gamma applies to straight colors only
+            for (int x = left; x <= right; ++x) {
+                auto pa = alpha_[base + x];
+                auto k = pa > 0.F ? 1.F / pa : 0.F;
+                a[x] = pa > 1.F ? 1.F : pa;
+                r[x] = gamma.ToSrgb(red_[base + x] * k);
+                g[x] = gamma.ToSrgb(green_[base + x] * k);
+                b[x] = gamma.ToSrgb(blue_[base + x] * k);
+            }
+            auto p = buffer + (base + left) * bpp;
+            switch (format) {
+                case PixelFormat::RGBAF: {
+                    for (int x = left; x <= right; ++x, p += bpp) {
+                        float v[4] = {r[x], g[x], b[x], a[x]};
+                        std::memcpy(p, v, sizeof(v));
+                    }
+                    break;
+                }
+                case PixelFormat::RGBA16: {
+                    for (int x = left; x <= right; ++x, p += bpp) {
+                        std::uint16_t v[4] = {
+                            Quantize16(r[x]), Quantize16(g[x]),
+                            Quantize16(b[x]), Quantize16(a[x]),
+                        };
+                        std::memcpy(p, v, sizeof(v));
+                    }
+                    break;
+                }
+                default: {
+                    for (int x = left; x <= right; ++x, p += bpp) {
+                        auto d = kDither[y & 3][x & 3];
+                        auto ca = Quantize8(a[x], d);
+                        // encoded colors are multiplied by stored alpha
+                        auto m = premul ? ca / 255.F : 1.F;
+                        auto cr = Quantize8(r[x] * m, d);
+                        auto cg = Quantize8(g[x] * m, d);
+                        auto cb = Quantize8(b[x] * m, d);
+                        if (format == PixelFormat::RGB8) {
+                            p[0] = cr;
+                            p[1] = cg;
+                            p[2] = cb;
+                        }
+                        else {
+                            color::StorePixel32(p,
+                                    color::PackPixel32(cr, cg, cb, ca));
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+private:
+    // 4x4 Bayer matrix, normalized to [0, 1)
+    static constexpr float kDither[4][4] = {
+        { 0 / 16.F,  8 / 16.F,  2 / 16.F, 10 / 16.F},
+        {12 / 16.F,  4 / 16.F, 14 / 16.F,  6 / 16.F},
+        { 3 / 16.F, 11 / 16.F,  1 / 16.F,  9 / 16.F},
+        {15 / 16.F,  7 / 16.F, 13 / 16.F,  5 / 16.F},
+    };
+
+    static color::Color8b Quantize8(float v, float dither) {
+        return color::ClampTo8b(v * 255.F + dither);
+    }
+
+    static std::uint16_t Quantize16(float v) {
+        return static_cast<std::uint16_t>(v * 65535.F + 0.5F);
+    }
+
+    using Plane = std::vector<float, util::DefaultInitAllocator<float>>;
+
+    int width_, height_;
+    Plane red_, green_, blue_, alpha_;
+    Scratch scratch_;
+};
+
+} // namespace cvf::render
+
+#endif // CANVASFLAT_RENDER_ACCUMBUF_H_
@@ -3,6 +3,9 @@
 
 #include <cstdio>
 #include <string>
+#include <vector>
+#include <cstddef>
+#include <functional>
 
 #include "render.h"
 #include "../util/mathutil.h"
@@ -15,6 +18,7 @@ public:
 
     void Redraw(const color::Color &backcolor,
             const shape::ShapeList &shapes) override {
+        auto instrument = profiling_ || heatmap_ != Heatmap::Off;
         if (show_progress_) {
             shape_count_ = shapes.size();
             current_title_.reserve(64);
@@ -25,26 +29,138 @@ public:
             progress_.Show();
             // async refresh progress bar
             auto task_refresh = progress_.RefreshAsync();
-            auto task_render = std::thread(&BasicRender::RenderProcess,
-                    this, backcolor, shapes);
+            auto task_render = std::thread(instrument
+                    ? &BasicRender::RenderProcess<true>
+                    : &BasicRender::RenderProcess<false>,
+                    this, std::cref(backcolor), std::cref(shapes));
             task_refresh.join();
             task_render.join();
         }
+        else if (instrument) {
+            RenderProcess<true>(backcolor, shapes);
+        }
+        else {
+            RenderProcess<false>(backcolor, shapes);
+        }
+    }
+
+protected:
+    // state of a thread drawing a band of the canvas
+    struct BandState {
+        BandState() : progress(false), slot(nullptr) {}
+
+        // pixels drawn by this band
+        shape::Rect area;
+        // progress is reported only by the thread drawing whole canvas
+        bool progress;
+        // null if profiling is disabled
+        util::Profiler::Slot *slot;
+        // visibility & colors of pixels in current row
+        std::vector<float> visible_row;
+        std::vector<color::SolidColor> color_row;
+        AccumBuffer::Scratch resolve;
+    };
+
+    // draw all pixels of 'draw_area_', called between the setup &
+    // cleanup of a redraw, parallel renders split it into bands
+    virtual void DrawBands(const color::Color &backcolor,
+            const shape::ShapeList &shapes, bool instrument) {
+        state_.area = draw_area_;
+        state_.progress = show_progress_;
+        state_.slot = instrument && profiling_ ? &profiler_.GetSlot()
+                : nullptr;
+        if (instrument) {
+            DrawBand<true>(backcolor, shapes, state_);
+        }
         else {
-            RenderProcess(backcolor, shapes);
+            DrawBand<false>(backcolor, shapes, state_);
+        }
+    }
+
+    // draw background & shapes in order within 'state.area', then
+    // resolve the area if high precision is enabled, each pixel is
+    // composited in the same order whatever the band is
+    template <bool kInstrument>
+    void DrawBand(const color::Color &backcolor,
+            const shape::ShapeList &shapes, BandState &state) {
+        using Clock = util::Profiler::Clock;
+        const auto &area = state.area;
+        if (area.left > area.right || area.top > area.bottom) return;
+        // entries: background, shapes, resolve
+        int shape_count = shapes.size();
+        auto slot = state.slot;
+        Clock::time_point time;
+        if constexpr (kInstrument) {
+            if (slot) time = Clock::now();
+        }
+        // draw the background
+        DrawBackground(backcolor, state);
+        if constexpr (kInstrument) {
+            if (slot) {
+                auto pixels = static_cast<long long>(
+                        area.right - area.left + 1)
+                        * (area.bottom - area.top + 1);
+                auto &entry = slot->entry(0);
+                entry.pixels_evaluated += pixels;
+                entry.pixels_blended += pixels;
+                auto now = Clock::now();
+                slot->AddSpan(0, time, now);
+                time = now;
+            }
+        }
+        // draw shapes
+        for (int i = 0; i < shape_count; ++i) {
+            DrawShape<kInstrument>(i, shapes[i], state);
+            if constexpr (kInstrument) {
+                if (slot) {
+                    auto now = Clock::now();
+                    slot->AddSpan(i + 1, time, now);
+                    time = now;
+                }
+            }
+        }
+        if (high_precision_) {
+            accum_.Resolve(buffer_, format_, area.left, area.top,
+                    area.right, area.bottom, state.resolve);
+        }
+        if constexpr (kInstrument) {
+            if (slot) slot->AddSpan(shape_count + 1, time, Clock::now());
+        }
+    }
+
+    // grow rows of 'state' for drawing bands of canvas, so drawing with
+    // a reserved state never allocates
+    void ReserveBand(BandState &state) {
+        if (static_cast<int>(state.visible_row.size()) < width_) {
+            state.visible_row.resize(width_);
+        }
+        ReserveColorRow(state, width_);
+        if (!high_precision_) return;
+        for (auto &&i : state.resolve.row) {
+            if (static_cast<int>(i.size()) < width_) i.resize(width_);
         }
     }
 
 private:
+    // profiling & heatmap are compiled out when 'kInstrument' is false
+    template <bool kInstrument>
     void RenderProcess(const color::Color &backcolor,
             const shape::ShapeList &shapes) {
-        // draw the background
-        DrawBackground(backcolor);
-        // draw shapes
-        int index = 0;
-        for (const auto &shape : shapes) {
-            DrawShape(index++, shape);
+        util::MathPrecisionScope precision(math_precision());
+        // entries: background, shapes, resolve
+        int shape_count = shapes.size();
+        auto profiling = kInstrument && profiling_;
+        if (profiling) {
+            profiler_.Start(shape_count + 2);
+            profiler_.set_name(0, "background");
+            for (int i = 0; i < shape_count; ++i) {
+                profiler_.set_name(i + 1, "shape " + std::to_string(i));
+            }
+            profiler_.set_name(shape_count + 1, "resolve");
         }
+        BeginDraw();
+        DrawBands(backcolor, shapes, kInstrument);
+        if (profiling) profiler_.Stop();
         // complete
         if (show_progress_) {
             UpdateProgress(shape_count_, 0, 0, 1, 1);
@@ -76,59 +192,85 @@ private:
         progress_.set_title(0, current_title_);
     }
 
-    void DrawBackground(const color::Color &backcolor) {
-        auto p = buffer_;
+    void DrawBackground(const color::Color &backcolor, BandState &state) {
+        const auto &area = state.area;
+        auto progress = state.progress;
         if (backcolor.is_solid()) {
             auto rgba = backcolor.GetColor();
-            for (int y = 0; y < height_; ++y) {
-                for (int x = 0; x < width_; ++x) {
-                    UpdateProgress(-1, x, y, width_, height_);
-                    *p++ = rgba.red;
-                    *p++ = rgba.green;
-                    *p++ = rgba.blue;
+            for (int y = area.top; y <= area.bottom; ++y) {
+                for (int x = area.left; x <= area.right; ++x) {
+                    if (progress) UpdateProgress(-1, x, y, width_, height_);
+                    DrawBackPixel(x, y, rgba);
                 }
             }
         }
         else {
-            for (int y = 0; y < height_; ++y) {
-                for (int x = 0; x < width_; ++x) {
-                    UpdateProgress(-1, x, y, width_, height_);
-                    auto px = static_cast<float>(x) / width_;
-                    auto py = static_cast<float>(y) / height_;
-                    // get non-solid color
-                    auto rgba = backcolor.GetColor(px, py);
-                    *p++ = rgba.red;
-                    *p++ = rgba.green;
-                    *p++ = rgba.blue;
+            // get non-solid colors row by row
+            int count = area.right - area.left + 1;
+            auto colors = ReserveColorRow(state, count);
+            for (int y = area.top; y <= area.bottom; ++y) {
+                backcolor.GetColorRow(area.left, y, width_, height_,
+                        count, colors);
+                for (int x = area.left; x <= area.right; ++x) {
+                    if (progress) UpdateProgress(-1, x, y, width_, height_);
+                    DrawBackPixel(x, y, colors[x - area.left]);
                 }
             }
         }
     }
 
-    void DrawShape(int index, const shape::ShapePtr &shape) {
+    template <bool kInstrument>
+    void DrawShape(int index, const shape::ShapePtr &shape,
+            BandState &state) {
+        auto slot = state.slot;
+        // pre-rendered shapes are composited directly
+        shape::Raster raster;
+        if (shape->GetRaster(raster)) {
+            auto blended = DrawRaster(raster, state.area);
+            if constexpr (kInstrument) {
+                if (slot) slot->entry(index + 1).pixels_blended += blended;
+            }
+            return;
+        }
         // get draw area
         shape::Rect area = shape->GetDrawArea(), draw;
-        draw.left = util::Max(area.left, 0);
-        draw.top = util::Max(area.top, 0);
-        draw.right = util::Min(area.right, width_ - 1);
-        draw.bottom = util::Min(area.bottom, height_ - 1);
-        // draw pixels in area
-        auto color = shape->color();
+        const auto &band = state.area;
+        draw.left = util::Max(area.left, band.left);
+        draw.top = util::Max(area.top, band.top);
+        draw.right = util::Min(area.right, band.right);
+        draw.bottom = util::Min(area.bottom, band.bottom);
+        if (draw.left > draw.right || draw.top > draw.bottom) return;
+        // draw pixels in area, visibility is evaluated row by row
+        const auto &color = shape->color();
+        int count = draw.right - draw.left + 1;
+        auto &visible_row = state.visible_row;
+        if (static_cast<int>(visible_row.size()) < count) {
+            visible_row.resize(count);
+        }
+        auto visible = visible_row.data();
+        // counters of profiling
+        long long evaluated = 0, blended = 0;
+        int heat = 0;
+        if constexpr (kInstrument) {
+            if (heatmap_ == Heatmap::Nodes) heat = shape->GetNodeCount();
+            if (heatmap_ == Heatmap::Shapes) heat = 1;
+        }
         if (color.is_solid()) {
             auto rgba = color.GetColor();
             for (int y = draw.top; y <= draw.bottom; ++y) {
-                for (int x = draw.left; x <= draw.right; ++x) {
-                    UpdateProgress(index, x, y,
-                            draw.right - draw.left + 1,
-                            draw.bottom - draw.top + 1);
-                    // calculate the pointer of current pixel
-                    auto p = buffer_ + (y * width_ + x) * 3;
+                if (state.progress) {
+                    UpdateProgress(index, draw.left, y,
+                            count, draw.bottom - draw.top + 1);
+                }
+                auto evals = GetVisibleRow(shape, draw.left, y,
+                        count, visible, heat);
+                if constexpr (kInstrument) evaluated += evals;
+                for (int i = 0; i < count; ++i) {
                     // draw pixel
-                    auto alpha = GetPixelVisible(x, y, shape) * rgba.alpha;
+                    auto alpha = visible[i] * rgba.alpha;
                     if (alpha > 0.F) {
-                        AlphaBlendX(p[0], rgba.red, alpha);
-                        AlphaBlendX(p[1], rgba.green, alpha);
-                        AlphaBlendX(p[2], rgba.blue, alpha);
+                        DrawPixel(draw.left + i, y, rgba, alpha);
+                        if constexpr (kInstrument) ++blended;
                     }
                 }
             }
@@ -136,31 +278,52 @@ private:
         else {   // non-solid color
             float aw = area.right - area.left + 1;
             float ah = area.bottom - area.top + 1;
+            auto colors = ReserveColorRow(state, count);
             for (int y = draw.top; y <= draw.bottom; ++y) {
-                for (int x = draw.left; x <= draw.right; ++x) {
-                    UpdateProgress(index, x, y,
-                            draw.right - draw.left + 1,
-                            draw.bottom - draw.top + 1);
-                    // calculate the pointer of current pixel
-                    auto p = buffer_ + (y * width_ + x) * 3;
-                    // get current color
-                    auto rgba = color.GetColor((x - area.left) / aw,
-                            (y - area.top) / ah);
+                if (state.progress) {
+                    UpdateProgress(index, draw.left, y,
+                            count, draw.bottom - draw.top + 1);
+                }
+                auto evals = GetVisibleRow(shape, draw.left, y,
+                        count, visible, heat);
+                if constexpr (kInstrument) evaluated += evals;
+                // get colors of current row
+                color.GetColorRow(draw.left - area.left, y - area.top,
+                        aw, ah, count, colors);
+                for (int i = 0; i < count; ++i) {
+                    const auto &rgba = colors[i];
                     // draw pixel
-                    auto alpha = GetPixelVisible(x, y, shape) * rgba.alpha;
+                    auto alpha = visible[i] * rgba.alpha;
                     if (alpha > 0.F) {
-                        AlphaBlendX(p[0], rgba.red, alpha);
-                        AlphaBlendX(p[1], rgba.green, alpha);
-                        AlphaBlendX(p[2], rgba.blue, alpha);
+                        DrawPixel(draw.left + i, y, rgba, alpha);
+                        if constexpr (kInstrument) ++blended;
                     }
                 }
             }
         }
+        if constexpr (kInstrument) {
+            if (!slot) return;
+            auto &entry = slot->entry(index + 1);
+            entry.pixels_evaluated += evaluated;
+            entry.pixels_blended += blended;
+            entry.sdf_evaluations += evaluated * shape->GetNodeCount();
+        }
+    }
+
+    // buffer of colors of a row, only grows
+    color::SolidColor *ReserveColorRow(BandState &state, int count) {
+        auto &color_row = state.color_row;
+        if (static_cast<int>(color_row.size()) < count) {
+            color_row.resize(count);
+        }
+        return color_row.data();
     }
 
     int shape_count_;
     char shape_indicator_[32];
     std::string current_title_;
+    // state of drawing the whole canvas in a single thread
+    BandState state_;
 };
 
 } // namespace cvf::render
@@ -0,0 +1,133 @@
+#ifndef CANVASFLAT_RENDER_MIPMAP_H_
+#define CANVASFLAT_RENDER_MIPMAP_H_
+
+#include <vector>
+
+#include "../color/solid.h"
+#include "../color/format.h"
+#include "../color/gamma.h"
+#include "../util/mathutil.h"
+
+namespace cvf::render {
+
+// pyramid of images halved from a rendered image, each level is box
+// filtered from the previous one in linear light with premultiplied
+// alpha, so the smaller images keep the brightness & edges of the
+// larger one, levels are stored in the format of the source image
+// odd sizes are rounded down, the last row or column is dropped
+class Mipmap {
+public:
+    Mipmap() : format_(color::PixelFormat::RGB8), source_(nullptr) {}
+
+    // build 'count' levels from the source image, level 0 is the source
+    // itself, which must outlive the mipmap
+    void Build(const unsigned char *buffer, int width, int height,
+            color::PixelFormat format, int count) {
+        format_ = format;
+        source_ = buffer;
+        count = util::Max(count, 1);
+        levels_.resize(count);
+        levels_[0].width = width;
+        levels_[0].height = height;
+        // decode source to linear light
+        Decode(buffer, width, height);
+        for (int i = 1; i < count; ++i) {
+            auto &level = levels_[i];
+            level.width = util::Max(levels_[i - 1].width / 2, 1);
+            level.height = util::Max(levels_[i - 1].height / 2, 1);
+            Halve(levels_[i - 1].width, levels_[i - 1].height,
+                    level.width, level.height);
+            Encode(level);
+        }
+    }
+
+    int level_count() const { return levels_.size(); }
+    int width(int level) const { return levels_[level].width; }
+    int height(int level) const { return levels_[level].height; }
+    color::PixelFormat format() const { return format_; }
+    const unsigned char *pixel(int level) const {
+        return level ? levels_[level].pixels.data() : source_;
+    }
+
+private:
+    struct Level {
+        int width, height;
+        std::vector<unsigned char> pixels;
+    };
+
+    void Decode(const unsigned char *buffer, int width, int height) {
+        using color::PixelFormat;
+        const auto &gamma = color::GammaTable::Get();
+        int size = width * height;
+        for (auto &&i : planes_) i.resize(size);
+        auto r = planes_[0].data(), g = planes_[1].data();
+        auto b = planes_[2].data(), a = planes_[3].data();
+        auto bpp = color::BytesPerPixel(format_);
+        for (int i = 0; i < size; ++i, buffer += bpp) {
+            if (format_ == PixelFormat::RGB8) {
+                r[i] = gamma.ToLinear(buffer[0]);
+                g[i] = gamma.ToLinear(buffer[1]);
+                b[i] = gamma.ToLinear(buffer[2]);
+                a[i] = 1.F;
+            }
+            else {
+                auto rgba = color::ReadPixel(buffer, format_);
+                r[i] = gamma.ToLinear(rgba.red) * rgba.alpha;
+                g[i] = gamma.ToLinear(rgba.green) * rgba.alpha;
+                b[i] = gamma.ToLinear(rgba.blue) * rgba.alpha;
+                a[i] = rgba.alpha;
+            }
+        }
+    }
+
+    // average 2x2 blocks of planes in place, rows of the result never
+    // overlap the source rows not yet read
+    void Halve(int src_width, int src_height, int width, int height) {
+        // sides of 1 pixel are averaged with themselves
+        int dx = src_width > 1 ? 1 : 0;
+        int dy = src_height > 1 ? src_width : 0;
+        for (auto &&plane : planes_) {
+            auto p = plane.data();
+            for (int y = 0; y < height; ++y) {
+                auto row0 = p + y * 2 * src_width, row1 = row0 + dy;
+                auto dst = p + y * width;
+                for (int x = 0; x < width; ++x) {
+                    dst[x] = (row0[x * 2] + row0[x * 2 + dx]
+                            + row1[x * 2] + row1[x * 2 + dx]) * 0.25F;
+                }
+            }
+        }
+    }
+
+    void Encode(Level &level) {
+        const auto &gamma = color::GammaTable::Get();
+        int size = level.width * level.height;
+        auto bpp = color::BytesPerPixel(format_);
+        level.pixels.resize(size * bpp);
+        auto r = planes_[0].data(), g = planes_[1].data();
+        auto b = planes_[2].data(), a = planes_[3].data();
+        auto p = level.pixels.data();
+        for (int i = 0; i < size; ++i, p += bpp) {
+            auto k = a[i] > 0.F ? 1.F / a[i] : 0.F;
+            color::SolidColor rgba(Quantize(gamma.ToSrgb(r[i] * k)),
+                    Quantize(gamma.ToSrgb(g[i] * k)),
+                    Quantize(gamma.ToSrgb(b[i] * k)),
+                    util::Min(a[i], 1.F));
+            color::WritePixel(p, format_, rgba);
+        }
+    }
+
+    static color::Color8b Quantize(float v) {
+        return color::ClampTo8b(v * 255.F + 0.5F);
+    }
+
+    color::PixelFormat format_;
+    const unsigned char *source_;
+    std::vector<Level> levels_;
+    // linear light premultiplied channels of current level
+    std::vector<float> planes_[4];
+};
+
+} // namespace cvf::render
+
+#endif // CANVASFLAT_RENDER_MIPMAP_H_
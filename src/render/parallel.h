@@ -0,0 +1,244 @@
+#ifndef CANVASFLAT_RENDER_PARALLEL_H_
+#define CANVASFLAT_RENDER_PARALLEL_H_
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <condition_variable>
+#include <cstring>
+#include <cstddef>
+
+#include "basic.h"
+#include "../util/mathutil.h"
+#include "../util/fastmath.h"
+#include "../util/affinity.h"
+
+namespace cvf::render {
+
+// render which draws bands of rows in parallel, each band is drawn
+// like a whole canvas, background first & then shapes in order, so
+// every pixel is composited in the same order & gets the same value
+// whatever the count of threads, the height of bands & the order in
+// which bands are scheduled
+// worker threads are created on the first redraw & kept until the
+// count of threads is changed, so redraws do not create threads
+class ParallelRender : public BasicRender {
+public:
+    // how bands are assigned to workers
+    enum class Schedule : char {
+        Dynamic,  // idle workers take the next band
+        Static    // band i is always drawn by worker i % thread count
+    };
+
+    ParallelRender() : ParallelRender(0) {}
+    // 0 threads means the count of hardware threads
+    ParallelRender(int thread_count)
+            : band_height_(32), schedule_(Schedule::Dynamic),
+              band_rows_(0), band_count_(0),
+              next_band_(0), done_bands_(0),
+              generation_(0), run_(), pending_(0), quit_(false) {
+        set_thread_count(thread_count);
+    }
+    ~ParallelRender() { StopWorkers(); }
+
+    // a newly allocated buffer is zeroed band by band by the workers
+    // which own the bands, so on NUMA systems the pages of a band are
+    // placed on the node of its worker, and stay there if the buffer
+    // is then drawn with static schedule & pinned workers
+    void ClearBuffer() override {
+        if (width_ <= 0 || height_ <= 0) return;
+        SetBands(0, height_ - 1);
+        RunBands([this](int, int band) {
+            int top = band * band_rows_;
+            int rows = util::Min(band_rows_, height_ - top);
+            std::memset(GetPixel(0, top), 0,
+                    static_cast<std::size_t>(width_) * rows * pixel_size_);
+        });
+    }
+
+    void set_thread_count(int thread_count) {
+        if (thread_count <= 0) {
+            thread_count = std::thread::hardware_concurrency();
+        }
+        thread_count_ = util::Max(thread_count, 1);
+    }
+    // rows of each band, 0 draws the whole canvas as a single band
+    void set_band_height(int band_height) {
+        band_height_ = util::Max(band_height, 0);
+    }
+    void set_schedule(Schedule schedule) { schedule_ = schedule; }
+    // pin worker i to CPU 'cpus[i % size]', empty to disable pinning,
+    // the thread calling 'Redraw' is worker 0, & is pinned only while
+    // it's drawing
+    void set_affinity(const std::vector<int> &cpus) { cpus_ = cpus; }
+
+    int thread_count() const { return thread_count_; }
+    int band_height() const { return band_height_; }
+    Schedule schedule() const { return schedule_; }
+    const std::vector<int> &affinity() const { return cpus_; }
+
+protected:
+    void DrawBands(const color::Color &backcolor,
+            const shape::ShapeList &shapes, bool instrument) override {
+        const auto &area = draw_area_;
+        if (area.left > area.right || area.top > area.bottom) return;
+        SetBands(area.top, area.bottom);
+        // workers drawing no band of this redraw may draw bands of
+        // the next one, so rows of all workers are reserved here
+        int thread_count = util::Min(thread_count_, band_count_);
+        if (static_cast<int>(states_.size()) < thread_count) {
+            states_.resize(thread_count);
+        }
+        for (auto &&state : states_) ReserveBand(state);
+        // layers render their buffers lazily, which must be done
+        // before they are drawn by several threads
+        for (const auto &shape : shapes) shape->GetDrawArea();
+        if (show_progress_) progress_.set_title(0, "current: drawing...");
+        RunBands([&](int index, int band) {
+            util::MathPrecisionScope precision(math_precision());
+            auto &state = states_[index];
+            state.progress = false;
+            state.slot = instrument && profiling_ ? &profiler_.GetSlot()
+                    : nullptr;
+            state.area = area;
+            state.area.top += band * band_rows_;
+            state.area.bottom = util::Min(state.area.top + band_rows_ - 1,
+                    area.bottom);
+            if (instrument) {
+                DrawBand<true>(backcolor, shapes, state);
+            }
+            else {
+                DrawBand<false>(backcolor, shapes, state);
+            }
+            // progress is reported by the first worker only
+            auto done = ++done_bands_;
+            if (!index && show_progress_) {
+                auto percent = static_cast<float>(done) / band_count_;
+                progress_.set_percent(0, percent);
+                progress_.set_percent(1, percent);
+            }
+        });
+    }
+
+private:
+    // split rows [top, bottom] into bands
+    void SetBands(int top, int bottom) {
+        int rows = bottom - top + 1;
+        band_rows_ = band_height_ ? util::Min(band_height_, rows) : rows;
+        band_count_ = (rows + band_rows_ - 1) / band_rows_;
+    }
+
+    // task of worker threads, type erased without allocation
+    struct Run {
+        void (*func)(ParallelRender *self, void *task, int index,
+                int thread_count);
+        void *task;
+        int thread_count;
+    };
+
+    // call 'task(worker, band)' for each band in worker threads,
+    // the calling thread is the first worker
+    template <typename Task>
+    void RunBands(Task task) {
+        int thread_count = util::Min(thread_count_, band_count_);
+        StartWorkers();
+        next_band_ = 0;
+        done_bands_ = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            run_.func = [](ParallelRender *self, void *task, int index,
+                    int thread_count) {
+                self->RunWorker(index, thread_count,
+                        *static_cast<Task *>(task));
+            };
+            run_.task = &task;
+            run_.thread_count = thread_count;
+            pending_ = thread_count - 1;
+            ++generation_;
+        }
+        start_.notify_all();
+        RunWorker(0, thread_count, task);
+        // wait for other workers
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return !pending_; });
+    }
+
+    // create workers 1 to 'thread_count_ - 1' if not created
+    void StartWorkers() {
+        if (static_cast<int>(threads_.size()) == thread_count_ - 1) return;
+        StopWorkers();
+        for (int i = 1; i < thread_count_; ++i) {
+            threads_.emplace_back(&ParallelRender::WorkerProcess, this, i,
+                    generation_);
+        }
+    }
+
+    void StopWorkers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            quit_ = true;
+        }
+        start_.notify_all();
+        for (auto &&i : threads_) i.join();
+        threads_.clear();
+        quit_ = false;
+    }
+
+    // wait for runs & join those which need this worker
+    void WorkerProcess(int index, std::uint64_t generation) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            start_.wait(lock, [this, generation] {
+                return quit_ || generation_ != generation;
+            });
+            if (quit_) return;
+            generation = generation_;
+            auto run = run_;
+            if (index >= run.thread_count) continue;
+            lock.unlock();
+            run.func(this, run.task, index, run.thread_count);
+            lock.lock();
+            if (!--pending_) done_.notify_one();
+        }
+    }
+
+    template <typename Task>
+    void RunWorker(int index, int thread_count, Task &task) {
+        util::AffinityScope affinity(cpus_.empty() ? -1
+                : cpus_[index % cpus_.size()]);
+        if (schedule_ == Schedule::Static) {
+            for (int band = index; band < band_count_;
+                    band += thread_count) {
+                task(index, band);
+            }
+        }
+        else {
+            for (int band; (band = next_band_++) < band_count_;) {
+                task(index, band);
+            }
+        }
+    }
+
+    int thread_count_, band_height_;
+    Schedule schedule_;
+    std::vector<int> cpus_;
+    // bands of current redraw
+    int band_rows_, band_count_;
+    std::atomic<int> next_band_, done_bands_;
+    // persistent workers & the current run
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable start_, done_;
+    std::uint64_t generation_;
+    Run run_;
+    int pending_;
+    bool quit_;
+    // state of each worker, kept between redraws
+    std::vector<BandState> states_;
+};
+
+} // namespace cvf::render
+
+#endif // CANVASFLAT_RENDER_PARALLEL_H_
@@ -0,0 +1,147 @@
+#ifndef CANVASFLAT_RENDER_PREVIEW_H_
+#define CANVASFLAT_RENDER_PREVIEW_H_
+
+#include <cmath>
+#include <vector>
+#include <ostream>
+
+#include "../color/color.h"
+#include "../color/solid.h"
+#include "../container/asciicont.h"
+#include "../shape/shape.h"
+#include "../util/mathutil.h"
+
+namespace cvf::render {
+
+// low resolution preview rendered straight at character cells,
+// each cell takes the area coverage of shapes over the whole cell
+// instead of sampling a full resolution image, pre-rendered shapes
+// are averaged over the cell, lines are written to stream as soon as
+// they are rendered
+class AsciiPreview {
+public:
+    // cells are twice as tall as wide, like most terminal fonts
+    AsciiPreview(int columns) : columns_(util::Max(columns, 1)) {}
+
+    void Render(int width, int height, const color::Color &backcolor,
+            const shape::ShapeList &shapes, std::ostream &os) {
+        float cell_w = static_cast<float>(width) / columns_;
+        float cell_h = cell_w * 2;
+        int rows = util::Max(static_cast<int>(height / cell_h), 1);
+        for (int i = 0; i < 3; ++i) row_[i].resize(columns_);
+        line_.resize(columns_ + 1);
+        line_[columns_] = '\n';
+        for (int row = 0; row < rows; ++row) {
+            float top = row * cell_h, bottom = top + cell_h;
+            // background at cell centers
+            for (int col = 0; col < columns_; ++col) {
+                auto rgba = backcolor.GetColor(
+                        (col + 0.5F) / columns_, (row + 0.5F) / rows);
+                SetCell(col, rgba);
+            }
+            for (const auto &shape : shapes) {
+                auto area = shape->GetDrawArea();
+                if (area.left > area.right || area.top > bottom
+                        || area.bottom < top) {
+                    continue;
+                }
+                shape::Raster raster;
+                if (shape->GetRaster(raster)) {
+                    DrawRaster(raster, cell_w, top, bottom);
+                    continue;
+                }
+                // cells overlapping the draw area
+                int first = util::Max(static_cast<int>(area.left / cell_w),
+                        0);
+                int last = util::Min(static_cast<int>(area.right / cell_w),
+                        columns_ - 1);
+                float aw = area.right - area.left + 1;
+                float ah = area.bottom - area.top + 1;
+                const auto &color = shape->color();
+                for (int col = first; col <= last; ++col) {
+                    // pixel (x, y) spans (x +- 0.5, y +- 0.5)
+                    shape::RectF cell(col * cell_w - 0.5F, top - 0.5F,
+                            (col + 1) * cell_w - 0.5F, bottom - 0.5F);
+                    auto coverage = shape->GetCoverage(cell);
+                    if (coverage <= 0.F) continue;
+                    auto rgba = color.is_solid() ? color.GetColor()
+                            : color.GetColor(
+                                (cell.center_x() - area.left) / aw,
+                                (cell.center_y() - area.top) / ah);
+                    BlendCell(col, rgba, coverage * rgba.alpha);
+                }
+            }
+            // map luma to characters
+            for (int col = 0; col < columns_; ++col) {
+                auto luma = container::GetLuma(row_[0][col], row_[1][col],
+                        row_[2][col]);
+                line_[col] = container::GetASCII(luma);
+            }
+            os.write(line_.data(), line_.size());
+        }
+        os.flush();
+    }
+
+private:
+    // composite pixels of a pre-rendered shape, which are averaged over
+    // each cell of the row between 'top' & 'bottom'
+    void DrawRaster(const shape::Raster &raster, float cell_w, float top,
+            float bottom) {
+        const auto &ra = raster.area;
+        // pixels whose centers are in the row
+        int y0 = std::ceil(top - 0.5F), y1 = std::ceil(bottom - 0.5F) - 1;
+        int stride = (ra.right - ra.left + 1) * 4;
+        int first = util::Max(static_cast<int>((ra.left + 0.5F) / cell_w),
+                0);
+        int last = util::Min(static_cast<int>((ra.right + 0.5F) / cell_w),
+                columns_ - 1);
+        for (int col = first; col <= last; ++col) {
+            int x0 = std::ceil(col * cell_w - 0.5F);
+            int x1 = std::ceil((col + 1) * cell_w - 0.5F) - 1;
+            int count = (x1 - x0 + 1) * (y1 - y0 + 1);
+            if (count <= 0) continue;
+            // pixels out of raster are transparent
+            int sum[4] = {};
+            int left = util::Max(x0, ra.left), right = util::Min(x1, ra.right);
+            for (int y = util::Max(y0, ra.top);
+                    y <= util::Min(y1, ra.bottom); ++y) {
+                auto p = raster.pixels + (y - ra.top) * stride
+                        + (left - ra.left) * 4;
+                for (int x = left; x <= right; ++x, p += 4) {
+                    for (int c = 0; c < 4; ++c) sum[c] += p[c];
+                }
+            }
+            // 'over' operator of premultiplied colors
+            auto k = raster.opacity / count;
+            auto alpha = sum[3] * k / 255.F;
+            for (int c = 0; c < 3; ++c) {
+                row_[c][col] = static_cast<color::Color8b>(
+                        row_[c][col] * (1 - alpha) + sum[c] * k);
+            }
+        }
+    }
+
+    void SetCell(int col, const color::SolidColor &rgba) {
+        row_[0][col] = rgba.red;
+        row_[1][col] = rgba.green;
+        row_[2][col] = rgba.blue;
+    }
+
+    void BlendCell(int col, const color::SolidColor &rgba, float alpha) {
+        auto blend = [alpha](color::Color8b &x, color::Color8b y) {
+            x = static_cast<color::Color8b>(x * (1 - alpha) + y * alpha);
+        };
+        blend(row_[0][col], rgba.red);
+        blend(row_[1][col], rgba.green);
+        blend(row_[2][col], rgba.blue);
+    }
+
+    int columns_;
+    // channels of cells in current row
+    std::vector<color::Color8b> row_[3];
+    std::vector<char> line_;
+};
+
+} // namespace cvf::render
+
+#endif // CANVASFLAT_RENDER_PREVIEW_H_
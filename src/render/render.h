@@ -2,26 +2,54 @@
 #define CANVASFLAT_RENDER_RENDER_H_
 
 #include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
 
 #include "../color/color.h"
+#include "../color/format.h"
+#include "accumbuf.h"
 #include "../shape/shape.h"
 #include "../util/mathutil.h"
+#include "../util/fastmath.h"
 #include "../util/progress.h"
+#include "../util/profiler.h"
 
 namespace cvf::render {
 
 class Render {
 public:
+    // metric of cost heatmap, counted per pixel
+    enum class Heatmap : char {
+        Off,
+        Shapes,   // count of shapes whose SDF is evaluated
+        Nodes     // count of SDF nodes evaluated
+    };
+
     virtual ~Render() = default;
 
     void ReadBuffer(unsigned char *buffer, int width, int height) {
+        ReadBuffer(buffer, width, height, color::PixelFormat::RGB8);
+    }
+    void ReadBuffer(unsigned char *buffer, int width, int height,
+            color::PixelFormat format) {
         buffer_ = buffer;
         width_ = width;
         height_ = height;
+        format_ = format;
+        pixel_size_ = color::BytesPerPixel(format);
     }
 
     virtual void Redraw(const color::Color &backcolor,
             const shape::ShapeList &shapes) = 0;
+    // zero the whole buffer, used on a newly allocated buffer whose
+    // memory is not touched yet, so parallel renders can place the
+    // pages near the threads which draw them
+    virtual void ClearBuffer() {
+        std::memset(buffer_, 0,
+                static_cast<std::size_t>(width_) * height_ * pixel_size_);
+    }
 
     void set_show_progress(bool show_progress) {
         show_progress_ = show_progress;
@@ -29,20 +57,284 @@ public:
     void set_anti_aliasing(bool anti_aliasing) {
         anti_aliasing_ = anti_aliasing;
     }
+    // composite in linear light with float precision,
+    // and quantize to the buffer format only once at the end
+    void set_high_precision(bool high_precision) {
+        high_precision_ = high_precision;
+    }
+    // use polynomial approximations in SDF kernels instead of libm
+    void set_fast_math(bool fast_math) {
+        fast_math_ = fast_math;
+    }
+    // use area coverage of pixels instead of point sampled SDF
+    // when anti-aliasing is enabled
+    void set_exact_coverage(bool exact_coverage) {
+        exact_coverage_ = exact_coverage;
+    }
+    // skip pixels far from the boundary of shapes with exact SDFs
+    void set_distance_skipping(bool distance_skipping) {
+        distance_skipping_ = distance_skipping;
+    }
+    // limit redraws to pixels in 'clip', others are left untouched
+    void set_clip(const shape::Rect &clip) {
+        clip_ = clip;
+        clipped_ = true;
+    }
+    void ResetClip() { clipped_ = false; }
+
+    // record time & pixel counters of each stage and shape,
+    // results are available from 'profiler' after a redraw
+    void set_profiling(bool profiling) { profiling_ = profiling; }
+    // count the cost of each pixel, which can be read by 'GetHeatmap'
+    void set_heatmap(Heatmap heatmap) { heatmap_ = heatmap; }
+
+    // write the heatmap of last redraw into a 'RGB8' buffer,
+    // counts are mapped linearly from [0, max_count] to a heat palette,
+    // the maximum count of heatmap is used if 'max_count' is 0
+    void GetHeatmap(unsigned char *buffer, int max_count) const {
+        int size = width_ * height_;
+        if (static_cast<int>(heat_.size()) < size) {
+            std::memset(buffer, 0, size * 3);
+            return;
+        }
+        if (max_count <= 0) {
+            for (int i = 0; i < size; ++i) {
+                max_count = util::Max<int>(max_count, heat_[i]);
+            }
+            if (!max_count) max_count = 1;
+        }
+        for (int i = 0; i < size; ++i, buffer += 3) {
+            GetHeatColor(static_cast<float>(heat_[i]) / max_count, buffer);
+        }
+    }
 
+    color::PixelFormat format() const { return format_; }
     bool anti_aliasing() const { return anti_aliasing_; }
+    bool high_precision() const { return high_precision_; }
+    bool exact_coverage() const { return exact_coverage_; }
+    bool fast_math() const { return fast_math_; }
+    bool distance_skipping() const { return distance_skipping_; }
     bool show_progress() const { return show_progress_; }
+    bool profiling() const { return profiling_; }
+    bool clipped() const { return clipped_; }
+    const shape::Rect &clip() const { return clip_; }
+    Heatmap heatmap() const { return heatmap_; }
+    const util::Profiler &profiler() const { return profiler_; }
+
+    // bits of settings which change rendered pixels, so that images
+    // rendered with different settings can be told apart
+    std::uint32_t setting_bits() const {
+        return anti_aliasing_ | high_precision_ << 1
+                | exact_coverage_ << 2 | fast_math_ << 3;
+    }
 
 protected:
     Render() : buffer_(nullptr), width_(0), height_(0),
-               anti_aliasing_(false), show_progress_(false) {}
+               format_(color::PixelFormat::RGB8), pixel_size_(3),
+               anti_aliasing_(false), show_progress_(false),
+               high_precision_(false), exact_coverage_(false),
+               fast_math_(false), profiling_(false),
+               distance_skipping_(false), clipped_(false),
+               heatmap_(Heatmap::Off) {}
 
     void AlphaBlendX(color::Color8b &x, color::Color8b y, float alpha) {
         x = static_cast<color::Color8b>(x * (1 - alpha) + y * alpha);
     }
 
+    // get the pointer of pixel (x, y) in buffer
+    unsigned char *GetPixel(int x, int y) const {
+        return buffer_ + (y * width_ + x) * pixel_size_;
+    }
+
+    // overwrite pixel with color, used when drawing background
+    void FillPixel(unsigned char *p, const color::SolidColor &rgba) {
+        color::WritePixel(p, format_, rgba);
+    }
+
+    // blend color into pixel with the 'over' operator
+    void BlendPixel(unsigned char *p, const color::SolidColor &rgba,
+            float alpha) {
+        switch (format_) {
+            case color::PixelFormat::RGB8: {
+                AlphaBlendX(p[0], rgba.red, alpha);
+                AlphaBlendX(p[1], rgba.green, alpha);
+                AlphaBlendX(p[2], rgba.blue, alpha);
+                break;
+            }
+            case color::PixelFormat::RGBA8: {
+                BlendStraight8(p, rgba, alpha);
+                break;
+            }
+            case color::PixelFormat::PremulRGBA8: {
+                BlendPremul8(p, rgba, alpha);
+                break;
+            }
+            default: {
+                BlendGeneric(p, rgba, alpha);
+                break;
+            }
+        }
+    }
+
+    util::MathPrecision math_precision() const {
+        return fast_math_ ? util::MathPrecision::Fast
+                : util::MathPrecision::Exact;
+    }
+
+    // prepare the render target of a redraw, the high precision buffer
+    // must be resolved after drawing
+    void BeginDraw() {
+        draw_area_ = shape::Rect(0, 0, width_ - 1, height_ - 1);
+        if (clipped_) {
+            draw_area_.left = util::Max(draw_area_.left, clip_.left);
+            draw_area_.top = util::Max(draw_area_.top, clip_.top);
+            draw_area_.right = util::Min(draw_area_.right, clip_.right);
+            draw_area_.bottom = util::Min(draw_area_.bottom, clip_.bottom);
+        }
+        if (high_precision_) accum_.Resize(width_, height_);
+        if (heatmap_ != Heatmap::Off) heat_.assign(width_ * height_, 0);
+    }
+
+    // draw pixel (x, y) of background
+    void DrawBackPixel(int x, int y, const color::SolidColor &rgba) {
+        if (high_precision_) {
+            accum_.Fill(x, y, rgba,
+                    color::HasAlpha(format_) ? rgba.alpha : 1.F);
+        }
+        else {
+            FillPixel(GetPixel(x, y), rgba);
+        }
+    }
+
+    // draw pixel (x, y) of a shape with specific coverage
+    void DrawPixel(int x, int y, const color::SolidColor &rgba,
+            float alpha) {
+        if (high_precision_) {
+            accum_.Blend(x, y, rgba, alpha);
+        }
+        else {
+            BlendPixel(GetPixel(x, y), rgba, alpha);
+        }
+    }
+
+    // composite pixels of a pre-rendered shape within 'area' with the
+    // 'over' operator, returns the count of blended pixels
+    long long DrawRaster(const shape::Raster &raster,
+            const shape::Rect &area) {
+        const auto &ra = raster.area;
+        int left = util::Max(ra.left, area.left);
+        int top = util::Max(ra.top, area.top);
+        int right = util::Min(ra.right, area.right);
+        int bottom = util::Min(ra.bottom, area.bottom);
+        if (left > right || top > bottom) return 0;
+        int stride = (ra.right - ra.left + 1) * 4;
+        auto src = raster.pixels + (top - ra.top) * stride
+                + (left - ra.left) * 4;
+        int count = right - left + 1;
+        auto fast = !high_precision_ && (format_ == color::PixelFormat::RGB8
+                || format_ == color::PixelFormat::PremulRGBA8);
+        for (int y = top; y <= bottom; ++y, src += stride) {
+            if (fast) {
+                BlendRasterRow(GetPixel(left, y), src, count,
+                        raster.opacity);
+                continue;
+            }
+            for (int i = 0; i < count; ++i) {
+                auto rgba = color::ReadPixel(src + i * 4,
+                        color::PixelFormat::PremulRGBA8);
+                auto alpha = rgba.alpha * raster.opacity;
+                if (alpha > 0.F) DrawPixel(left + i, y, rgba, alpha);
+            }
+        }
+        return static_cast<long long>(count) * (bottom - top + 1);
+    }
+
+    // pixel coverage is nonzero only within this distance of boundary,
+    // which is larger than half of the diagonal of a pixel
+    static constexpr float kCoverageMargin = 0.75F;
+    // tolerance of SDF error when skipping pixels
+    static constexpr float kSkipEpsilon = 1e-3F;
+
+    // get visibility of 'count' pixels from (x, y) along the row,
+    // 'heat' is added to the heatmap of pixels which are evaluated,
+    // returns the count of evaluated pixels
+    int GetVisibleRow(const shape::ShapePtr &shape, int x, int y,
+            int count, float *visible, int heat) {
+        if (distance_skipping_ && shape->IsExact()) {
+            return MarchVisibleRow(shape, x, y, count, visible, heat);
+        }
+        if (anti_aliasing_ && exact_coverage_) {
+            for (int i = 0; i < count; ++i) {
+                visible[i] = GetPixelCoverage(x + i, y, shape);
+            }
+        }
+        else {
+            shape->GetSDFRow(x, y, count, visible);
+            for (int i = 0; i < count; ++i) {
+                visible[i] = GetVisible(visible[i]);
+            }
+        }
+        AddHeat(x, y, count, heat);
+        return count;
+    }
+
+    // march along the row like sphere tracing, the SDF of a pixel also
+    // decides the pixels closer than its magnitude, which are either
+    // invisible or fully covered, so only pixels near the boundary are
+    // evaluated, requires an exact SDF
+    int MarchVisibleRow(const shape::ShapePtr &shape, int x, int y,
+            int count, float *visible, int heat) {
+        // pixels are invisible above 'outer' & fully covered below 'inner'
+        float outer = 0.F, inner = 0.F;
+        if (anti_aliasing_) {
+            outer = exact_coverage_ ? kCoverageMargin : 0.5F;
+            inner = -outer;
+        }
+        int evaluated = 0;
+        for (int i = 0; i < count;) {
+            auto sdf = shape->GetSDF(x + i, y);
+            ++evaluated;
+            if (heat) heat_[y * width_ + x + i] += heat;
+            // count of following pixels sharing the state of this one
+            float run = 0.F, value = 0.F;
+            if (sdf > outer) {
+                run = std::ceil(sdf - outer - kSkipEpsilon) - 1;
+                value = 0.F;
+            }
+            else if (sdf <= inner) {
+                run = std::floor(inner - sdf - kSkipEpsilon);
+                value = 1.F;
+            }
+            else {
+                value = anti_aliasing_ && exact_coverage_
+                        ? GetPixelCoverage(x + i, y, shape)
+                        : GetVisible(sdf);
+            }
+            visible[i++] = value;
+            int last = i + util::Min<float>(util::Max(run, 0.F), count - i);
+            for (; i < last; ++i) visible[i] = value;
+        }
+        return evaluated;
+    }
+
+    // add cost to 'count' pixels of heatmap from (x, y) along the row
+    void AddHeat(int x, int y, int count, int heat) {
+        if (!heat) return;
+        auto p = heat_.data() + y * width_ + x;
+        for (int i = 0; i < count; ++i) p[i] += heat;
+    }
+
+    float GetPixelCoverage(int x, int y, const shape::ShapePtr &shape) {
+        shape::RectF pixel(x - 0.5F, y - 0.5F, x + 0.5F, y + 0.5F);
+        return shape->GetCoverage(pixel);
+    }
+
     float GetPixelVisible(float x, float y, const shape::ShapePtr &shape) {
-        auto sdf = shape->GetSDF(x, y);
+        return GetVisible(shape->GetSDF(x, y));
+    }
+
+    // map SDF value to pixel coverage
+    float GetVisible(float sdf) const {
         if (anti_aliasing_) {
             return util::LinearMapping(sdf, -0.5, 0.5, 1, 0);
         }
@@ -53,8 +345,116 @@ protected:
 
     unsigned char *buffer_;
     int width_, height_;
-    bool anti_aliasing_, show_progress_;
+    color::PixelFormat format_;
+    int pixel_size_;
+    bool anti_aliasing_, show_progress_, high_precision_, exact_coverage_;
+    bool fast_math_, profiling_, distance_skipping_, clipped_;
+    shape::Rect clip_;
+    // pixels drawn in current redraw, the clipped area of buffer
+    shape::Rect draw_area_;
     util::Progress progress_;
+    util::Profiler profiler_;
+    Heatmap heatmap_;
+    std::vector<std::uint32_t> heat_;
+    AccumBuffer accum_;
+
+private:
+    // black, blue, green, yellow, red, white
+    static void GetHeatColor(float t, unsigned char *rgb) {
+        static const unsigned char kPalette[][3] = {
+            {0, 0, 0}, {0, 0, 255}, {0, 255, 0},
+            {255, 255, 0}, {255, 0, 0}, {255, 255, 255},
+        };
+        constexpr int kLast = sizeof(kPalette) / sizeof(kPalette[0]) - 1;
+        t = (t < 0.F ? 0.F : (t > 1.F ? 1.F : t)) * kLast;
+        int i = util::Min(static_cast<int>(t), kLast - 1);
+        auto k = t - i;
+        for (int c = 0; c < 3; ++c) {
+            rgb[c] = kPalette[i][c] * (1 - k) + kPalette[i + 1][c] * k + 0.5F;
+        }
+    }
+
+    // blend a row of premultiplied pixels into 'RGB8' or 'PremulRGBA8'
+    // buffer in fixed point, dst = src * k + dst * (1 - src_alpha * k)
+    void BlendRasterRow(unsigned char *p, const unsigned char *src,
+            int count, float opacity) {
+        int k = opacity * 256.F + 0.5F;
+        auto div255 = [](int v) { return (v + 128 + ((v + 128) >> 8)) >> 8; };
+        if (format_ == color::PixelFormat::RGB8) {
+            for (int i = 0; i < count; ++i, p += 3, src += 4) {
+                int inv = 255 - ((src[3] * k) >> 8);
+                p[0] = ((src[0] * k) >> 8) + div255(p[0] * inv);
+                p[1] = ((src[1] * k) >> 8) + div255(p[1] * inv);
+                p[2] = ((src[2] * k) >> 8) + div255(p[2] * inv);
+            }
+        }
+        else {
+            for (int i = 0; i < count * 4; i += 4) {
+                int inv = 255 - ((src[i + 3] * k) >> 8);
+                for (int c = 0; c < 4; ++c) {
+                    p[i + c] = ((src[i + c] * k) >> 8) + div255(p[i + c] * inv);
+                }
+            }
+        }
+    }
+
+    // blend kernels of 4-byte formats, load & store pixel in 32-bit
+    void BlendStraight8(unsigned char *p, const color::SolidColor &rgba,
+            float alpha) {
+        using namespace color;
+        auto v = LoadPixel32(p);
+        float dr = (v >> kRedShift) & 0xff, dg = (v >> kGreenShift) & 0xff;
+        float db = (v >> kBlueShift) & 0xff;
+        float da = ((v >> kAlphaShift) & 0xff) / 255.F * (1 - alpha);
+        auto oa = alpha + da;
+        if (oa <= 0.F) return;
+        auto ka = alpha / oa, kd = da / oa;
+        StorePixel32(p, PackPixel32(rgba.red * ka + dr * kd + 0.5F,
+                rgba.green * ka + dg * kd + 0.5F,
+                rgba.blue * ka + db * kd + 0.5F, AlphaTo8b(oa)));
+    }
+
+    void BlendPremul8(unsigned char *p, const color::SolidColor &rgba,
+            float alpha) {
+        using namespace color;
+        auto v = LoadPixel32(p);
+        auto kd = 1 - alpha;
+        float dr = (v >> kRedShift) & 0xff, dg = (v >> kGreenShift) & 0xff;
+        float db = (v >> kBlueShift) & 0xff, da = (v >> kAlphaShift) & 0xff;
+        StorePixel32(p, PackPixel32(rgba.red * alpha + dr * kd + 0.5F,
+                rgba.green * alpha + dg * kd + 0.5F,
+                rgba.blue * alpha + db * kd + 0.5F,
+                255.F * alpha + da * kd + 0.5F));
+    }
+
+    // wide formats, decode to float then encode back
+    void BlendGeneric(unsigned char *p, const color::SolidColor &rgba,
+            float alpha) {
+        float d[4];
+        if (format_ == color::PixelFormat::RGBAF) {
+            std::memcpy(d, p, sizeof(d));
+        }
+        else {
+            std::uint16_t v[4];
+            std::memcpy(v, p, sizeof(v));
+            for (int i = 0; i < 4; ++i) d[i] = v[i] / 65535.F;
+        }
+        auto da = d[3] * (1 - alpha), oa = alpha + da;
+        if (oa <= 0.F) return;
+        auto ka = alpha / oa / 255.F, kd = da / oa;
+        d[0] = rgba.red * ka + d[0] * kd;
+        d[1] = rgba.green * ka + d[1] * kd;
+        d[2] = rgba.blue * ka + d[2] * kd;
+        d[3] = oa;
+        if (format_ == color::PixelFormat::RGBAF) {
+            std::memcpy(p, d, sizeof(d));
+        }
+        else {
+            std::uint16_t v[4];
+            for (int i = 0; i < 4; ++i) v[i] = d[i] * 65535.F + 0.5F;
+            std::memcpy(p, v, sizeof(v));
+        }
+    }
 };
 
 using RenderPtr = std::unique_ptr<Render>;
@@ -0,0 +1,114 @@
+#ifndef CANVASFLAT_RENDER_TILECACHE_H_
+#define CANVASFLAT_RENDER_TILECACHE_H_
+
+#include <list>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <iterator>
+#include <functional>
+#include <unordered_map>
+
+#include "../shape/shape.h"
+
+namespace cvf::render {
+
+// region of canvas rendered at a scale, for a version of scene and
+// the settings of render, see 'Render::setting_bits'
+struct TileKey {
+    shape::Rect region;
+    float scale;
+    std::uint64_t version;
+    std::uint32_t settings;
+
+    bool operator==(const TileKey &rhs) const {
+        return region.left == rhs.region.left
+                && region.top == rhs.region.top
+                && region.right == rhs.region.right
+                && region.bottom == rhs.region.bottom
+                && scale == rhs.scale && version == rhs.version
+                && settings == rhs.settings;
+    }
+};
+
+// least recently used cache of rendered tiles
+class TileCache {
+public:
+    TileCache() : capacity_(64) {}
+
+    // get pixels of tile, null if not cached
+    const unsigned char *Find(const TileKey &key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) return nullptr;
+        // move to front, the back is evicted first
+        tiles_.splice(tiles_.begin(), tiles_, it->second);
+        return it->second->pixels.data();
+    }
+
+    void Insert(const TileKey &key, const unsigned char *pixels,
+            std::size_t size) {
+        if (!capacity_) return;
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            tiles_.erase(it->second);
+            index_.erase(it);
+        }
+        // reuse the memory of evicted tile
+        if (static_cast<int>(tiles_.size()) >= capacity_) {
+            index_.erase(tiles_.back().key);
+            tiles_.splice(tiles_.begin(), tiles_, std::prev(tiles_.end()));
+        }
+        else {
+            tiles_.emplace_front();
+        }
+        auto &tile = tiles_.front();
+        tile.key = key;
+        tile.pixels.assign(pixels, pixels + size);
+        index_[key] = tiles_.begin();
+    }
+
+    void Clear() {
+        tiles_.clear();
+        index_.clear();
+    }
+
+    // maximum count of tiles, 0 disables the cache
+    void set_capacity(int capacity) {
+        capacity_ = capacity;
+        while (static_cast<int>(tiles_.size()) > capacity_) {
+            index_.erase(tiles_.back().key);
+            tiles_.pop_back();
+        }
+    }
+
+    int capacity() const { return capacity_; }
+    int size() const { return tiles_.size(); }
+
+private:
+    struct Tile {
+        TileKey key;
+        std::vector<unsigned char> pixels;
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const TileKey &key) const {
+            std::uint64_t h = key.version * 1000003 + key.settings;
+            for (auto v : {key.region.left, key.region.top,
+                    key.region.right, key.region.bottom}) {
+                h = h * 1000003 + static_cast<std::uint32_t>(v);
+            }
+            std::uint32_t scale;
+            std::memcpy(&scale, &key.scale, sizeof(scale));
+            return std::hash<std::uint64_t>()(h * 1000003 + scale);
+        }
+    };
+
+    int capacity_;
+    std::list<Tile> tiles_;
+    std::unordered_map<TileKey, std::list<Tile>::iterator, KeyHash> index_;
+};
+
+} // namespace cvf::render
+
+#endif // CANVASFLAT_RENDER_TILECACHE_H_
@@ -0,0 +1,146 @@
+#ifndef CANVASFLAT_RENDER_VERIFY_H_
+#define CANVASFLAT_RENDER_VERIFY_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+#include "parallel.h"
+#include "../color/color.h"
+#include "../color/format.h"
+#include "../shape/shape.h"
+
+namespace cvf::render {
+
+// checks parallel render is reproducible, by rendering a scene under
+// several schedules & comparing the checksums of results, the first
+// differing pixel is reported if any result is different
+class ScheduleVerifier {
+public:
+    struct Schedule {
+        int thread_count, band_height;
+        ParallelRender::Schedule schedule;
+    };
+
+    ScheduleVerifier() : mismatch_(-1), mismatch_x_(-1), mismatch_y_(-1) {
+        // a single band is drawn the same as 'BasicRender'
+        using Kind = ParallelRender::Schedule;
+        schedules_ = {{1, 0, Kind::Dynamic}, {2, 1, Kind::Static},
+                {3, 7, Kind::Dynamic}, {0, 64, Kind::Static}};
+    }
+
+    void AddSchedule(int thread_count, int band_height) {
+        AddSchedule(thread_count, band_height,
+                ParallelRender::Schedule::Dynamic);
+    }
+    void AddSchedule(int thread_count, int band_height,
+            ParallelRender::Schedule schedule) {
+        schedules_.push_back({thread_count, band_height, schedule});
+    }
+    void ClearSchedule() { schedules_.clear(); }
+
+    // render with the options of 'render', the schedule of 'render' is
+    // restored after verification, but its buffer is replaced
+    bool Verify(ParallelRender &render, int width, int height,
+            color::PixelFormat format, const color::Color &backcolor,
+            const shape::ShapeList &shapes) {
+        mismatch_ = mismatch_x_ = mismatch_y_ = -1;
+        checksums_.clear();
+        error_.clear();
+        if (schedules_.empty()) return true;
+        auto bpp = color::BytesPerPixel(format);
+        std::size_t size = static_cast<std::size_t>(width) * height * bpp;
+        auto thread_count = render.thread_count();
+        auto band_height = render.band_height();
+        auto schedule = render.schedule();
+        for (std::size_t i = 0; i < schedules_.size(); ++i) {
+            // the first result is the reference
+            auto &buffer = i ? buffer_ : reference_;
+            buffer.assign(size, 0);
+            render.set_thread_count(schedules_[i].thread_count);
+            render.set_band_height(schedules_[i].band_height);
+            render.set_schedule(schedules_[i].schedule);
+            render.ReadBuffer(buffer.data(), width, height, format);
+            render.Redraw(backcolor, shapes);
+            checksums_.push_back(Checksum(buffer.data(), size));
+            if (checksums_[i] == checksums_[0]
+                    && !std::memcmp(buffer.data(), reference_.data(), size)) {
+                continue;
+            }
+            // find the first differing pixel
+            mismatch_ = i;
+            for (std::size_t p = 0; p < size; p += bpp) {
+                if (std::memcmp(&buffer[p], &reference_[p], bpp)) {
+                    mismatch_x_ = p / bpp % width;
+                    mismatch_y_ = p / bpp / width;
+                    break;
+                }
+            }
+            char msg[128];
+            std::snprintf(msg, sizeof(msg), "schedule %d (%d threads, "
+                    "band height %d, %s) differs at pixel (%d, %d)",
+                    mismatch_, render.thread_count(), render.band_height(),
+                    render.schedule() == ParallelRender::Schedule::Static
+                        ? "static" : "dynamic",
+                    mismatch_x_, mismatch_y_);
+            error_ = msg;
+            break;
+        }
+        render.set_thread_count(thread_count);
+        render.set_band_height(band_height);
+        render.set_schedule(schedule);
+        return mismatch_ < 0;
+    }
+
+    // Fletcher-like sums of 32-bit words in 8 independent lanes, which
+    // compilers turn into SIMD adds, the second sums make it sensitive
+    // to the order of words
+    static std::uint64_t Checksum(const unsigned char *data,
+            std::size_t size) {
+        constexpr int kLanes = 8;
+        std::uint32_t a[kLanes] = {}, b[kLanes] = {};
+        std::size_t i = 0;
+        for (; i + sizeof(a) <= size; i += sizeof(a)) {
+            std::uint32_t w[kLanes];
+            std::memcpy(w, data + i, sizeof(w));
+            for (int l = 0; l < kLanes; ++l) {
+                a[l] += w[l];
+                b[l] += a[l];
+            }
+        }
+        // mix lanes & the remaining bytes
+        constexpr std::uint64_t kPrime = 0x100000001b3;
+        std::uint64_t h = size;
+        for (int l = 0; l < kLanes; ++l) {
+            h = (h ^ a[l]) * kPrime;
+            h = (h ^ b[l]) * kPrime;
+        }
+        for (; i < size; ++i) h = (h ^ data[i]) * kPrime;
+        return h;
+    }
+
+    const std::vector<Schedule> &schedules() const { return schedules_; }
+    // checksums of results, in the order of schedules
+    const std::vector<std::uint64_t> &checksums() const {
+        return checksums_;
+    }
+    // index of the first differing schedule, -1 if none
+    int mismatch() const { return mismatch_; }
+    int mismatch_x() const { return mismatch_x_; }
+    int mismatch_y() const { return mismatch_y_; }
+    const std::string &error() const { return error_; }
+
+private:
+    std::vector<Schedule> schedules_;
+    std::vector<std::uint64_t> checksums_;
+    int mismatch_, mismatch_x_, mismatch_y_;
+    std::string error_;
+    std::vector<unsigned char> reference_, buffer_;
+};
+
+} // namespace cvf::render
+
+#endif // CANVASFLAT_RENDER_VERIFY_H_
@@ -0,0 +1,180 @@
+#ifndef CANVASFLAT_SCENE_FORMAT_H_
+#define CANVASFLAT_SCENE_FORMAT_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include "../shape/operation.h"
+#include "../shape/squircle.h"
+
+// records of scene description, shared by the text format & the binary
+// format, all records have fixed sizes and no pointers, so a binary scene
+// is just these records laid out in a file and can be used in place
+//
+// binary layout (little endian):
+//   SceneHeader
+//   SceneNode  * node_count
+//   SceneDraw  * draw_count
+namespace cvf::scene {
+
+// "CVFS" in little endian
+constexpr std::uint32_t kSceneMagic = 0x53465643;
+constexpr std::uint32_t kSceneVersion = 1;
+
+enum class NodeKind : std::uint8_t {
+    Circle, Rectangle, Capsule, Squircle, Operation
+};
+
+enum class ColorKind : std::uint8_t {
+    Solid, Linear, Radial
+};
+
+struct SceneColor {
+    ColorKind kind;
+    std::uint8_t reserved[3];
+    std::uint32_t rgb1, rgb2;
+    float alpha1, alpha2, start, end, radian;
+};
+
+// primitives store their constructor arguments in 'params',
+// operations store the opcode of 'shape::Operation', operands and
+// the parameter, operands always refer to nodes before the operation
+struct SceneNode {
+    NodeKind kind;
+    std::uint8_t opcode;
+    std::uint16_t reserved;
+    std::int32_t operands[2];
+    float params[5];
+};
+
+struct SceneDraw {
+    std::int32_t node;
+    SceneColor color;
+};
+
+struct SceneHeader {
+    std::uint32_t magic, version;
+    std::int32_t width, height;
+    std::uint32_t node_count, draw_count;
+    SceneColor backcolor;
+};
+
+static_assert(sizeof(SceneColor) == 32, "unexpected padding");
+static_assert(sizeof(SceneNode) == 32, "unexpected padding");
+static_assert(sizeof(SceneDraw) == 36, "unexpected padding");
+static_assert(sizeof(SceneHeader) == 56, "unexpected padding");
+
+// read-only view of scene records, does not own the memory
+class SceneView {
+public:
+    SceneView() : header_(nullptr), nodes_(nullptr), draws_(nullptr) {}
+
+    // view a binary scene in place, returns false & sets 'error'
+    // if the data is not a valid scene
+    bool Open(const void *data, std::size_t size) {
+        auto bytes = static_cast<const unsigned char *>(data);
+        if (reinterpret_cast<std::uintptr_t>(data) % alignof(SceneHeader)) {
+            return SetError("misaligned scene data");
+        }
+        if (size < sizeof(SceneHeader)) return SetError("truncated header");
+        auto header = reinterpret_cast<const SceneHeader *>(bytes);
+        if (header->magic != kSceneMagic) return SetError("bad magic");
+        if (header->version != kSceneVersion) {
+            return SetError("unsupported version");
+        }
+        auto need = sizeof(SceneHeader)
+                + header->node_count * sizeof(SceneNode)
+                + header->draw_count * sizeof(SceneDraw);
+        if (size < need) return SetError("truncated scene");
+        auto nodes = reinterpret_cast<const SceneNode *>(
+                bytes + sizeof(SceneHeader));
+        auto draws = reinterpret_cast<const SceneDraw *>(
+                nodes + header->node_count);
+        return Open(header, nodes, draws);
+    }
+
+    // view records in separate arrays
+    bool Open(const SceneHeader *header, const SceneNode *nodes,
+            const SceneDraw *draws) {
+        header_ = header;
+        nodes_ = nodes;
+        draws_ = draws;
+        return Validate();
+    }
+
+    const SceneHeader &header() const { return *header_; }
+    int width() const { return header_->width; }
+    int height() const { return header_->height; }
+    int node_count() const { return header_->node_count; }
+    int draw_count() const { return header_->draw_count; }
+    const SceneNode &node(int index) const { return nodes_[index]; }
+    const SceneDraw &draw(int index) const { return draws_[index]; }
+    const std::string &error() const { return error_; }
+
+    // orders of squircle are integers in [1, kMaxOrder], NaN fails too
+    static bool IsValidOrder(float order) {
+        return order >= 1.F && order <= shape::Squircle::kMaxOrder
+                && order == static_cast<int>(order);
+    }
+
+private:
+    bool SetError(const char *error) {
+        error_ = error;
+        header_ = nullptr;
+        return false;
+    }
+
+    bool Validate() {
+        if (header_->width <= 0 || header_->height <= 0) {
+            return SetError("bad canvas size");
+        }
+        if (!IsValid(header_->backcolor)) return SetError("bad color");
+        for (int i = 0; i < node_count(); ++i) {
+            const auto &node = nodes_[i];
+            if (node.kind > NodeKind::Operation) {
+                return SetError("bad node kind");
+            }
+            if (node.kind == NodeKind::Squircle
+                    && !IsValidOrder(node.params[3])) {
+                return SetError("bad order of squircle");
+            }
+            if (node.kind != NodeKind::Operation) continue;
+            using Opcode = shape::Operation::Opcode;
+            if (node.opcode > static_cast<int>(Opcode::SmoothDifference)) {
+                return SetError("bad opcode");
+            }
+            // boolean operations take two operands
+            auto opcode = static_cast<Opcode>(node.opcode);
+            int count = shape::Operation::IsBinary(opcode) ? 2 : 1;
+            for (int j = 0; j < count; ++j) {
+                if (node.operands[j] < 0 || node.operands[j] >= i) {
+                    return SetError("bad operand");
+                }
+            }
+        }
+        for (int i = 0; i < draw_count(); ++i) {
+            const auto &draw = draws_[i];
+            if (draw.node < 0 || draw.node >= node_count()) {
+                return SetError("bad node of draw");
+            }
+            if (!IsValid(draw.color)) return SetError("bad color");
+        }
+        error_.clear();
+        return true;
+    }
+
+    static bool IsValid(const SceneColor &color) {
+        return color.kind <= ColorKind::Radial;
+    }
+
+    const SceneHeader *header_;
+    const SceneNode *nodes_;
+    const SceneDraw *draws_;
+    std::string error_;
+};
+
+} // namespace cvf::scene
+
+#endif // CANVASFLAT_SCENE_FORMAT_H_
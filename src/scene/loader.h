@@ -0,0 +1,159 @@
+#ifndef CANVASFLAT_SCENE_LOADER_H_
+#define CANVASFLAT_SCENE_LOADER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstddef>
+
+#include "format.h"
+#include "text.h"
+#include "mapped.h"
+#include "../canvas.h"
+#include "../color/color.h"
+#include "../shape/shape.h"
+#include "../shape/circle.h"
+#include "../shape/rectangle.h"
+#include "../shape/capsule.h"
+#include "../shape/squircle.h"
+#include "../shape/operation.h"
+
+namespace cvf::scene {
+
+// build shape trees from scene records
+class SceneLoader {
+public:
+    SceneLoader() : width_(0), height_(0) {}
+
+    // build from records, returns false & sets 'error' on failure
+    bool Load(const SceneView &view) {
+        width_ = view.width();
+        height_ = view.height();
+        backcolor_ = MakeColor(view.header().backcolor);
+        // operands always come first, so one pass builds every node and
+        // nodes shared by several operations are built only once
+        nodes_.clear();
+        nodes_.reserve(view.node_count());
+        for (int i = 0; i < view.node_count(); ++i) {
+            nodes_.push_back(MakeNode(view.node(i)));
+        }
+        // each drawn shape carries its own color, so a node drawn more
+        // than once gets a copy of its root for every later draw
+        std::vector<bool> drawn(view.node_count());
+        shapes_.clear();
+        shapes_.reserve(view.draw_count());
+        for (int i = 0; i < view.draw_count(); ++i) {
+            const auto &draw = view.draw(i);
+            auto shape = drawn[draw.node] ? MakeNode(view.node(draw.node))
+                                          : nodes_[draw.node];
+            drawn[draw.node] = true;
+            shape->set_color(MakeColor(draw.color));
+            shapes_.push_back(shape);
+        }
+        return true;
+    }
+
+    // load text or binary scene file, binary scenes are mapped
+    // into memory and used in place without parsing
+    bool LoadFile(const char *path) {
+        MappedFile file;
+        if (!file.Open(path)) return SetError("can not open file");
+        return LoadData(file.data(), file.size());
+    }
+
+    // load text or binary scene in memory, binary scenes are
+    // detected by the magic number and must be 4-byte aligned
+    bool LoadData(const void *data, std::size_t size) {
+        SceneView view;
+        if (size >= sizeof(kSceneMagic)
+                && !std::memcmp(data, &kSceneMagic, sizeof(kSceneMagic))) {
+            if (!view.Open(data, size)) return SetError(view.error());
+            return Load(view);
+        }
+        // otherwise it's a text scene
+        SceneData scene;
+        auto text = static_cast<const char *>(data);
+        if (!scene.ParseText(std::string(text, text + size))) {
+            return SetError(scene.error());
+        }
+        if (!scene.GetView(view)) return SetError(view.error());
+        return Load(view);
+    }
+
+    // replace size, background & shapes of canvas
+    void Apply(Canvas &canvas) const {
+        canvas.set_size(width_, height_);
+        canvas.set_backcolor(backcolor_);
+        canvas.ClearShape();
+        for (const auto &shape : shapes_) canvas.AddShape(shape);
+    }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    const color::Color &backcolor() const { return backcolor_; }
+    const shape::ShapeList &shapes() const { return shapes_; }
+    const std::string &error() const { return error_; }
+
+private:
+    bool SetError(const std::string &error) {
+        error_ = error;
+        return false;
+    }
+
+    shape::ShapePtr MakeNode(const SceneNode &node) const {
+        using namespace shape;
+        const auto &p = node.params;
+        switch (node.kind) {
+            case NodeKind::Circle: {
+                return std::make_shared<Circle>(p[0], p[1], p[2]);
+            }
+            case NodeKind::Rectangle: {
+                return std::make_shared<Rectangle>(p[0], p[1], p[2], p[3]);
+            }
+            case NodeKind::Capsule: {
+                return std::make_shared<Capsule>(p[0], p[1], p[2], p[3],
+                        p[4]);
+            }
+            case NodeKind::Squircle: {
+                return std::make_shared<Squircle>(p[0], p[1], p[2],
+                        static_cast<int>(p[3]));
+            }
+            default: {
+                auto opcode = static_cast<Operation::Opcode>(node.opcode);
+                const auto &opr1 = nodes_[node.operands[0]];
+                if (opcode <= Operation::Opcode::Difference) {
+                    return std::make_shared<Operation>(opcode, opr1,
+                            nodes_[node.operands[1]]);
+                }
+                if (Operation::IsBinary(opcode)) {
+                    return std::make_shared<Operation>(opcode, opr1,
+                            nodes_[node.operands[1]], p[0]);
+                }
+                return std::make_shared<Operation>(opcode, opr1, p[0]);
+            }
+        }
+    }
+
+    static color::Color MakeColor(const SceneColor &color) {
+        using namespace color;
+        SolidColor color1(color.rgb1, color.alpha1);
+        if (color.kind == ColorKind::Solid) return color1;
+        SolidColor color2(color.rgb2, color.alpha2);
+        auto type = color.kind == ColorKind::Linear
+                ? Color::ColorType::Linear : Color::ColorType::Radial;
+        return Color(type, color1, color2, color.start, color.end,
+                color.radian);
+    }
+
+    int width_, height_;
+    color::Color backcolor_;
+    // all nodes of the last loaded scene
+    shape::ShapeList nodes_;
+    shape::ShapeList shapes_;
+    std::string error_;
+};
+
+} // namespace cvf::scene
+
+#endif // CANVASFLAT_SCENE_LOADER_H_
@@ -0,0 +1,57 @@
+#ifndef CANVASFLAT_SCENE_MAPPED_H_
+#define CANVASFLAT_SCENE_MAPPED_H_
+
+#include <cstddef>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace cvf::scene {
+
+// read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() : data_(nullptr), size_(0) {}
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool Open(const char *path) {
+        Close();
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+            close(fd);
+            return false;
+        }
+        auto data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping is still valid after closing the file
+        close(fd);
+        if (data == MAP_FAILED) return false;
+        data_ = data;
+        size_ = st.st_size;
+        return true;
+    }
+
+    void Close() {
+        if (data_) munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    // page aligned, so records of binary scene can be used in place
+    const void *data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    void *data_;
+    std::size_t size_;
+};
+
+} // namespace cvf::scene
+
+#endif // CANVASFLAT_SCENE_MAPPED_H_
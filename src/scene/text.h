@@ -0,0 +1,337 @@
+#ifndef CANVASFLAT_SCENE_TEXT_H_
+#define CANVASFLAT_SCENE_TEXT_H_
+
+#include <cstdint>
+#include <cstdlib>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <unordered_map>
+
+#include "format.h"
+#include "../shape/operation.h"
+#include "../util/mathutil.h"
+
+// text format of scene, one statement per line, '#' starts a comment
+//
+//   canvas <width> <height>
+//   background <color>
+//   <name> = circle <center_x> <center_y> <r>
+//   <name> = rect <x0> <y0> <width> <height>
+//   <name> = capsule <x0> <y0> <x1> <y1> <r>
+//   <name> = squircle <center_x> <center_y> <r> [order]
+//   <name> = union | intersection | difference <name> <name>
+//   <name> = smooth_union | smooth_intersection
+//            | smooth_difference <name> <name> <k>
+//   <name> = rotate | scale | round | blur | outline
+//            | offset_x | offset_y <name> <param>
+//   draw <name> <color>
+//
+//   <color> = solid <rgb> [alpha]
+//           | linear <rgb> <alpha> <rgb> <alpha> [radian [start end]]
+//           | radial <rgb> <alpha> <rgb> <alpha> [start end]
+//   <rgb>   = hexadecimal RGB, e.g. '0278E2' or '#0278E2'
+//
+// shapes are drawn in the order of 'draw' statements
+namespace cvf::scene {
+
+// scene records owned in memory, parsed from text or built by code
+class SceneData {
+public:
+    SceneData() {
+        header_.magic = kSceneMagic;
+        header_.version = kSceneVersion;
+        header_.width = header_.height = 0;
+        header_.node_count = header_.draw_count = 0;
+        header_.backcolor = MakeSolid(0xFFFFFF, 1.F);
+    }
+
+    // parse scene from text, returns false & sets 'error' on failure
+    bool ParseText(const std::string &text) {
+        std::istringstream iss(text);
+        std::string line;
+        int line_no = 0;
+        while (std::getline(iss, line)) {
+            ++line_no;
+            auto comment = line.find('#');
+            // '#' directly followed by a hex digit is a color
+            while (comment != std::string::npos && comment + 1 < line.size()
+                    && std::isxdigit(static_cast<unsigned char>(
+                        line[comment + 1]))) {
+                comment = line.find('#', comment + 1);
+            }
+            if (comment != std::string::npos) line.resize(comment);
+            std::istringstream ls(line);
+            std::vector<std::string> tokens;
+            for (std::string t; ls >> t;) tokens.push_back(t);
+            if (tokens.empty()) continue;
+            if (!ParseStatement(tokens)) {
+                error_ = "line " + std::to_string(line_no) + ": " + error_;
+                return false;
+            }
+        }
+        if (header_.width <= 0 || header_.height <= 0) {
+            return SetError("missing 'canvas' statement");
+        }
+        return true;
+    }
+
+    bool ParseFile(const char *path) {
+        std::ifstream ifs(path);
+        if (!ifs.is_open()) return SetError("can not open file");
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        return ParseText(ss.str());
+    }
+
+    // write the binary form, which can be loaded by 'SceneLoader'
+    bool SaveBinary(const char *path) const {
+        std::ofstream ofs(path, std::ios::binary);
+        if (!ofs.is_open()) return false;
+        ofs.write(reinterpret_cast<const char *>(&header_), sizeof(header_));
+        ofs.write(reinterpret_cast<const char *>(nodes_.data()),
+                nodes_.size() * sizeof(SceneNode));
+        ofs.write(reinterpret_cast<const char *>(draws_.data()),
+                draws_.size() * sizeof(SceneDraw));
+        return ofs.good();
+    }
+
+    // building scene by code, returns the index of node
+    int AddNode(const SceneNode &node) {
+        nodes_.push_back(node);
+        header_.node_count = nodes_.size();
+        return nodes_.size() - 1;
+    }
+    void AddDraw(int node, const SceneColor &color) {
+        draws_.push_back({node, color});
+        header_.draw_count = draws_.size();
+    }
+    void set_size(int width, int height) {
+        header_.width = width;
+        header_.height = height;
+    }
+    void set_backcolor(const SceneColor &color) {
+        header_.backcolor = color;
+    }
+
+    // view records, the view is invalidated if data is modified
+    bool GetView(SceneView &view) const {
+        return view.Open(&header_, nodes_.data(), draws_.data());
+    }
+
+    const std::string &error() const { return error_; }
+
+    static SceneColor MakeSolid(std::uint32_t rgb, float alpha) {
+        SceneColor color = {};
+        color.kind = ColorKind::Solid;
+        color.rgb1 = color.rgb2 = rgb;
+        color.alpha1 = color.alpha2 = alpha;
+        return color;
+    }
+
+private:
+    bool SetError(const std::string &error) {
+        error_ = error;
+        return false;
+    }
+
+    bool ParseStatement(const std::vector<std::string> &tokens) {
+        if (tokens[0] == "canvas") {
+            if (tokens.size() != 3) return SetError("bad 'canvas'");
+            int w, h;
+            if (!ParseInt(tokens[1], w) || !ParseInt(tokens[2], h)
+                    || w <= 0 || h <= 0) {
+                return SetError("bad canvas size");
+            }
+            set_size(w, h);
+            return true;
+        }
+        if (tokens[0] == "background") {
+            return ParseColor(tokens, 1, header_.backcolor);
+        }
+        if (tokens[0] == "draw") {
+            if (tokens.size() < 3) return SetError("bad 'draw'");
+            int node;
+            if (!FindNode(tokens[1], node)) return false;
+            SceneColor color;
+            if (!ParseColor(tokens, 2, color)) return false;
+            AddDraw(node, color);
+            return true;
+        }
+        if (tokens.size() >= 3 && tokens[1] == "=") {
+            if (names_.count(tokens[0])) {
+                return SetError("redefinition of '" + tokens[0] + "'");
+            }
+            SceneNode node = {};
+            if (!ParseNode(tokens, node)) return false;
+            names_[tokens[0]] = AddNode(node);
+            return true;
+        }
+        return SetError("unknown statement '" + tokens[0] + "'");
+    }
+
+    bool ParseNode(const std::vector<std::string> &tokens, SceneNode &node) {
+        using Opcode = shape::Operation::Opcode;
+        static const std::unordered_map<std::string, Opcode> kOpcodes = {
+            {"union", Opcode::Union}, {"intersection", Opcode::Intersection},
+            {"difference", Opcode::Difference}, {"rotate", Opcode::Rotate},
+            {"scale", Opcode::Scale}, {"round", Opcode::Round},
+            {"blur", Opcode::Blur}, {"outline", Opcode::Outline},
+            {"offset_x", Opcode::OffsetX}, {"offset_y", Opcode::OffsetY},
+            {"smooth_union", Opcode::SmoothUnion},
+            {"smooth_intersection", Opcode::SmoothIntersection},
+            {"smooth_difference", Opcode::SmoothDifference},
+        };
+        const auto &type = tokens[2];
+        int argc = tokens.size() - 3;
+        auto args = tokens.data() + 3;
+        if (auto it = kOpcodes.find(type); it != kOpcodes.end()) {
+            node.kind = NodeKind::Operation;
+            node.opcode = static_cast<std::uint8_t>(it->second);
+            // smooth operations take a blend radius after operands
+            auto binary = shape::Operation::IsBinary(it->second);
+            auto smooth = binary && it->second > Opcode::Difference;
+            if (argc != (smooth ? 3 : 2)) {
+                return SetError("bad operands of '" + type + "'");
+            }
+            if (!FindNode(args[0], node.operands[0])) return false;
+            if (smooth) {
+                return FindNode(args[1], node.operands[1])
+                        && ParseFloat(args[2], node.params[0]);
+            }
+            if (binary) return FindNode(args[1], node.operands[1]);
+            return ParseFloat(args[1], node.params[0]);
+        }
+        int min_argc, max_argc;
+        if (type == "circle") {
+            node.kind = NodeKind::Circle;
+            min_argc = max_argc = 3;
+        }
+        else if (type == "rect") {
+            node.kind = NodeKind::Rectangle;
+            min_argc = max_argc = 4;
+        }
+        else if (type == "capsule") {
+            node.kind = NodeKind::Capsule;
+            min_argc = max_argc = 5;
+        }
+        else if (type == "squircle") {
+            node.kind = NodeKind::Squircle;
+            min_argc = 3;
+            max_argc = 4;
+            // default order of 'shape::Squircle'
+            node.params[3] = 2;
+        }
+        else {
+            return SetError("unknown shape '" + type + "'");
+        }
+        if (argc < min_argc || argc > max_argc) {
+            return SetError("bad arguments of '" + type + "'");
+        }
+        for (int i = 0; i < argc; ++i) {
+            if (!ParseFloat(args[i], node.params[i])) return false;
+        }
+        if (node.kind == NodeKind::Squircle
+                && !SceneView::IsValidOrder(node.params[3])) {
+            return SetError("bad order of 'squircle'");
+        }
+        return true;
+    }
+
+    bool ParseColor(const std::vector<std::string> &tokens, int pos,
+            SceneColor &color) {
+        int argc = tokens.size() - pos - 1;
+        if (argc < 0) return SetError("missing color");
+        const auto &type = tokens[pos];
+        auto args = tokens.data() + pos + 1;
+        color = MakeSolid(0, 1.F);
+        if (type == "solid") {
+            if (argc < 1 || argc > 2) return SetError("bad solid color");
+            if (!ParseRGB(args[0], color.rgb1)) return false;
+            if (argc == 2 && !ParseFloat(args[1], color.alpha1)) return false;
+            color.rgb2 = color.rgb1;
+            color.alpha2 = color.alpha1;
+            return true;
+        }
+        // gradients
+        if (type == "linear") {
+            color.kind = ColorKind::Linear;
+            if (argc != 4 && argc != 5 && argc != 7) {
+                return SetError("bad linear gradient");
+            }
+        }
+        else if (type == "radial") {
+            color.kind = ColorKind::Radial;
+            if (argc != 4 && argc != 6) {
+                return SetError("bad radial gradient");
+            }
+        }
+        else {
+            return SetError("unknown color '" + type + "'");
+        }
+        if (!ParseRGB(args[0], color.rgb1)
+                || !ParseFloat(args[1], color.alpha1)
+                || !ParseRGB(args[2], color.rgb2)
+                || !ParseFloat(args[3], color.alpha2)) {
+            return false;
+        }
+        // default direction of linear gradient is from top to bottom
+        color.start = 0.F;
+        color.end = 1.F;
+        color.radian = color.kind == ColorKind::Linear ? util::PI_2 : 0.F;
+        int next = 4;
+        if (color.kind == ColorKind::Linear && argc >= 5) {
+            if (!ParseFloat(args[next++], color.radian)) return false;
+        }
+        if (next < argc) {
+            if (!ParseFloat(args[next], color.start)
+                    || !ParseFloat(args[next + 1], color.end)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool FindNode(const std::string &name, std::int32_t &index) {
+        auto it = names_.find(name);
+        if (it == names_.end()) {
+            return SetError("undefined shape '" + name + "'");
+        }
+        index = it->second;
+        return true;
+    }
+
+    bool ParseInt(const std::string &str, int &value) {
+        char *end;
+        value = std::strtol(str.c_str(), &end, 10);
+        if (*end) return SetError("bad integer '" + str + "'");
+        return true;
+    }
+
+    bool ParseFloat(const std::string &str, float &value) {
+        char *end;
+        value = std::strtof(str.c_str(), &end);
+        if (*end) return SetError("bad number '" + str + "'");
+        return true;
+    }
+
+    bool ParseRGB(const std::string &str, std::uint32_t &rgb) {
+        auto s = str.c_str() + (str[0] == '#' ? 1 : 0);
+        char *end;
+        rgb = std::strtoul(s, &end, 16);
+        if (*end || end - s != 6) return SetError("bad color '" + str + "'");
+        return true;
+    }
+
+    SceneHeader header_;
+    std::vector<SceneNode> nodes_;
+    std::vector<SceneDraw> draws_;
+    std::unordered_map<std::string, int> names_;
+    std::string error_;
+};
+
+} // namespace cvf::scene
+
+#endif // CANVASFLAT_SCENE_TEXT_H_
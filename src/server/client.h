@@ -0,0 +1,91 @@
+#ifndef CANVASFLAT_SERVER_CLIENT_H_
+#define CANVASFLAT_SERVER_CLIENT_H_
+
+#include <cstring>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "protocol.h"
+
+namespace cvf::server {
+
+// client of 'RenderServer', requests are sent one at a time
+class RenderClient {
+public:
+    RenderClient() : fd_(-1) {}
+    ~RenderClient() { Close(); }
+
+    RenderClient(const RenderClient &) = delete;
+    RenderClient &operator=(const RenderClient &) = delete;
+
+    bool Connect(const char *path) {
+        Close();
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (std::strlen(path) >= sizeof(addr.sun_path)) {
+            return SetError("socket path is too long");
+        }
+        std::strcpy(addr.sun_path, path);
+        fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd_ < 0) return SetError("can not create socket");
+        if (connect(fd_, reinterpret_cast<sockaddr *>(&addr),
+                sizeof(addr)) < 0) {
+            Close();
+            return SetError("can not connect to server");
+        }
+        return true;
+    }
+
+    void Close() {
+        if (fd_ >= 0) close(fd_);
+        fd_ = -1;
+    }
+
+    // render the scene on server, the encoded image is stored in 'image'
+    // returns false & sets 'error' on failure
+    bool Render(const void *scene, std::size_t size, ImageFormat format,
+            std::vector<unsigned char> &image) {
+        if (fd_ < 0) return SetError("not connected");
+        if (size > kMaxSceneSize) return SetError("scene is too large");
+        RequestHeader request = {kRequestMagic, format,
+                static_cast<std::uint32_t>(size)};
+        ResponseHeader response;
+        if (!WriteAll(fd_, &request, sizeof(request))
+                || !WriteAll(fd_, scene, size)
+                || !ReadAll(fd_, &response, sizeof(response))) {
+            Close();
+            return SetError("connection closed");
+        }
+        image.resize(response.size);
+        if (!ReadAll(fd_, image.data(), response.size)) {
+            Close();
+            return SetError("connection closed");
+        }
+        if (response.status != Status::OK) {
+            error_.assign(image.begin(), image.end());
+            image.clear();
+            return false;
+        }
+        return true;
+    }
+
+    const std::string &error() const { return error_; }
+
+private:
+    bool SetError(const char *error) {
+        error_ = error;
+        return false;
+    }
+
+    int fd_;
+    std::string error_;
+};
+
+} // namespace cvf::server
+
+#endif // CANVASFLAT_SERVER_CLIENT_H_
@@ -0,0 +1,110 @@
+#ifndef CANVASFLAT_SERVER_PROTOCOL_H_
+#define CANVASFLAT_SERVER_PROTOCOL_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <cerrno>
+#include <vector>
+#include <streambuf>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+
+// protocol between render server & client, both run on the same machine
+// so all integers are in native byte order
+//
+// request:  RequestHeader, scene (text or binary, see 'scene/format.h')
+// response: ResponseHeader, encoded image or error message
+//
+// a connection can carry any number of requests, one after another
+namespace cvf::server {
+
+// "CVFR" in little endian
+constexpr std::uint32_t kRequestMagic = 0x52465643;
+// scenes larger than this are rejected
+constexpr std::uint32_t kMaxSceneSize = 256U << 20;
+// canvases of more pixels than this are rejected, e.g. 8192 x 8192
+constexpr std::uint64_t kMaxPixelCount = 64U << 20;
+
+enum class ImageFormat : std::uint32_t {
+    PNG, PPM
+};
+
+enum class Status : std::uint32_t {
+    OK, Error
+};
+
+struct RequestHeader {
+    std::uint32_t magic;
+    ImageFormat format;
+    std::uint32_t size;
+};
+
+struct ResponseHeader {
+    Status status;
+    std::uint32_t size;
+};
+
+// read/write exactly 'size' bytes, returns false if the peer is closed
+inline bool ReadAll(int fd, void *data, std::size_t size) {
+    auto p = static_cast<char *>(data);
+    while (size) {
+        auto ret = recv(fd, p, size, 0);
+        if (ret < 0 && errno == EINTR) continue;
+        if (ret <= 0) return false;
+        p += ret;
+        size -= ret;
+    }
+    return true;
+}
+
+inline bool WriteAll(int fd, const void *data, std::size_t size) {
+    auto p = static_cast<const char *>(data);
+    while (size) {
+        auto ret = send(fd, p, size, MSG_NOSIGNAL);
+        if (ret < 0 && errno == EINTR) continue;
+        if (ret <= 0) return false;
+        p += ret;
+        size -= ret;
+    }
+    return true;
+}
+
+// FNV-1a hash of bytes
+inline std::uint64_t HashBytes(const void *data, std::size_t size) {
+    auto p = static_cast<const unsigned char *>(data);
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ p[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// stream buffer that appends to a byte vector, whose capacity is kept
+// after 'Clear', so encoding images into it stops allocating once warm
+class ByteBuffer : public std::streambuf {
+public:
+    void Clear() { bytes_.clear(); }
+
+    const std::vector<unsigned char> &bytes() const { return bytes_; }
+
+protected:
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            bytes_.push_back(traits_type::to_char_type(c));
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override {
+        bytes_.insert(bytes_.end(), s, s + n);
+        return n;
+    }
+
+private:
+    std::vector<unsigned char> bytes_;
+};
+
+} // namespace cvf::server
+
+#endif // CANVASFLAT_SERVER_PROTOCOL_H_
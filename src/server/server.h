@@ -0,0 +1,275 @@
+#ifndef CANVASFLAT_SERVER_SERVER_H_
+#define CANVASFLAT_SERVER_SERVER_H_
+
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <list>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <ostream>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "protocol.h"
+#include "../canvas.h"
+#include "../render/basic.h"
+#include "../container/pngcont.h"
+#include "../container/ppmcont.h"
+#include "../scene/loader.h"
+#include "../util/mathutil.h"
+
+namespace cvf::server {
+
+// resident render server listening on a unix domain socket
+// each worker keeps its own canvas, render & encoders, so buffers are
+// reused between requests, shape trees of recent scenes are cached by
+// the hash of scene data and shared by all workers
+class RenderServer {
+public:
+    RenderServer()
+            : RenderServer(std::thread::hardware_concurrency(), 16) {}
+    RenderServer(int worker_count, int cache_capacity)
+            : worker_count_(util::Max(worker_count, 1)),
+              cache_capacity_(util::Max(cache_capacity, 1)),
+              listen_fd_(-1), running_(false),
+              cache_hits_(0), cache_misses_(0) {}
+    ~RenderServer() { Stop(); }
+
+    RenderServer(const RenderServer &) = delete;
+    RenderServer &operator=(const RenderServer &) = delete;
+
+    // start listening & serving in background threads
+    // returns false & sets 'error' on failure
+    bool Start(const char *path) {
+        if (running_) return SetError("server is already running");
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (std::strlen(path) >= sizeof(addr.sun_path)) {
+            return SetError("socket path is too long");
+        }
+        std::strcpy(addr.sun_path, path);
+        listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd_ < 0) return SetError("can not create socket");
+        // remove the socket file left by last run
+        unlink(path);
+        if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr),
+                sizeof(addr)) < 0 || listen(listen_fd_, SOMAXCONN) < 0) {
+            close(listen_fd_);
+            listen_fd_ = -1;
+            return SetError("can not listen on socket");
+        }
+        path_ = path;
+        running_ = true;
+        // initialize workers
+        workers_.clear();
+        for (int i = 0; i < worker_count_; ++i) {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+        for (auto &&worker : workers_) {
+            worker->thread = std::thread(&RenderServer::WorkerProcess,
+                    this, worker.get());
+        }
+        acceptor_ = std::thread(&RenderServer::AcceptProcess, this);
+        return true;
+    }
+
+    // stop serving, connections in progress are closed
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) return;
+            running_ = false;
+            // wake up threads blocked in 'accept' or 'recv'
+            shutdown(listen_fd_, SHUT_RDWR);
+            for (const auto &worker : workers_) {
+                if (worker->fd >= 0) shutdown(worker->fd, SHUT_RDWR);
+            }
+        }
+        cond_.notify_all();
+        acceptor_.join();
+        for (auto &&worker : workers_) worker->thread.join();
+        close(listen_fd_);
+        listen_fd_ = -1;
+        for (auto fd : pending_) close(fd);
+        pending_.clear();
+        unlink(path_.c_str());
+    }
+
+    const std::string &error() const { return error_; }
+    long long cache_hits() const { return cache_hits_; }
+    long long cache_misses() const { return cache_misses_; }
+
+private:
+    using ScenePtr = std::shared_ptr<const scene::SceneLoader>;
+
+    struct Worker {
+        Worker()
+                : canvas(1, 1),
+                  ppm(container::PpmContainer::Format::PPM, true), fd(-1) {
+            auto render = std::make_unique<render::BasicRender>();
+            render->set_anti_aliasing(true);
+            canvas.set_render(std::move(render));
+        }
+
+        Canvas canvas;
+        container::PngContainer png;
+        container::PpmContainer ppm;
+        std::vector<unsigned char> request;
+        ByteBuffer response;
+        std::thread thread;
+        // connection being served, guarded by 'mutex_'
+        int fd;
+    };
+
+    struct CacheEntry {
+        std::uint64_t hash;
+        std::vector<unsigned char> data;
+        ScenePtr scene;
+    };
+
+    bool SetError(const char *error) {
+        error_ = error;
+        return false;
+    }
+
+    void AcceptProcess() {
+        for (;;) {
+            int fd = accept(listen_fd_, nullptr, nullptr);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                if (fd >= 0) close(fd);
+                return;
+            }
+            if (fd < 0) continue;
+            pending_.push_back(fd);
+            cond_.notify_one();
+        }
+    }
+
+    void WorkerProcess(Worker *worker) {
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [this] {
+                    return !running_ || !pending_.empty();
+                });
+                if (!running_) return;
+                worker->fd = pending_.front();
+                pending_.pop_front();
+            }
+            while (Serve(*worker)) {}
+            std::lock_guard<std::mutex> lock(mutex_);
+            close(worker->fd);
+            worker->fd = -1;
+        }
+    }
+
+    // serve one request, returns false if the connection should be closed
+    bool Serve(Worker &worker) {
+        RequestHeader header;
+        if (!ReadAll(worker.fd, &header, sizeof(header))) return false;
+        if (header.magic != kRequestMagic) {
+            Respond(worker, Status::Error, "bad request");
+            return false;
+        }
+        if (header.size > kMaxSceneSize) {
+            Respond(worker, Status::Error, "scene is too large");
+            return false;
+        }
+        worker.request.resize(header.size);
+        if (!ReadAll(worker.fd, worker.request.data(), header.size)) {
+            return false;
+        }
+        // get shape trees
+        std::string error;
+        auto scene = GetScene(worker.request, error);
+        if (!scene) return Respond(worker, Status::Error, error);
+        // render & encode
+        auto &canvas = worker.canvas;
+        scene->Apply(canvas);
+        canvas.Redraw();
+        container::ImageContainer *cont = &worker.png;
+        if (header.format == ImageFormat::PPM) cont = &worker.ppm;
+        cont->ReadBuffer(canvas.pixel(), canvas.width(), canvas.height(),
+                canvas.format());
+        worker.response.Clear();
+        std::ostream os(&worker.response);
+        cont->Export(os);
+        const auto &bytes = worker.response.bytes();
+        ResponseHeader response = {Status::OK,
+                static_cast<std::uint32_t>(bytes.size())};
+        return WriteAll(worker.fd, &response, sizeof(response))
+                && WriteAll(worker.fd, bytes.data(), bytes.size());
+    }
+
+    bool Respond(Worker &worker, Status status, const std::string &msg) {
+        ResponseHeader response = {status,
+                static_cast<std::uint32_t>(msg.size())};
+        return WriteAll(worker.fd, &response, sizeof(response))
+                && WriteAll(worker.fd, msg.data(), msg.size());
+    }
+
+    // find shape trees in cache, or build them on miss
+    ScenePtr GetScene(const std::vector<unsigned char> &data,
+            std::string &error) {
+        auto hash = HashBytes(data.data(), data.size());
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex_);
+            for (auto it = cache_.begin(); it != cache_.end(); ++it) {
+                // data is compared in case of hash collision
+                if (it->hash == hash && it->data == data) {
+                    // move to front, the back is evicted first
+                    cache_.splice(cache_.begin(), cache_, it);
+                    ++cache_hits_;
+                    return it->scene;
+                }
+            }
+            ++cache_misses_;
+        }
+        // build outside the lock, so other workers are not blocked
+        auto loader = std::make_shared<scene::SceneLoader>();
+        if (!loader->LoadData(data.data(), data.size())) {
+            error = loader->error();
+            return nullptr;
+        }
+        // the canvas size is given by client, check it before allocating
+        if (static_cast<std::uint64_t>(loader->width()) * loader->height()
+                > kMaxPixelCount) {
+            error = "canvas is too large";
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        cache_.push_front({hash, data, loader});
+        if (static_cast<int>(cache_.size()) > cache_capacity_) {
+            cache_.pop_back();
+        }
+        return loader;
+    }
+
+    int worker_count_, cache_capacity_;
+    std::string path_, error_;
+    int listen_fd_;
+    // guards 'running_', 'pending_' & 'fd' of workers
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool running_;
+    std::deque<int> pending_;
+    std::thread acceptor_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    // shape trees of recent scenes, most recently used first
+    std::mutex cache_mutex_;
+    std::list<CacheEntry> cache_;
+    std::atomic<long long> cache_hits_, cache_misses_;
+};
+
+} // namespace cvf::server
+
+#endif // CANVASFLAT_SERVER_SERVER_H_
@@ -0,0 +1,106 @@
+#ifndef CANVASFLAT_SHAPE_ANIMATED_H_
+#define CANVASFLAT_SHAPE_ANIMATED_H_
+
+#include <cmath>
+#include <memory>
+#include <functional>
+
+#include "shape.h"
+#include "../color/color.h"
+#include "../color/solid.h"
+
+namespace cvf::shape {
+
+// shape whose offset, rotation, scale & color are functions of time,
+// the operand is scaled & rotated around the center of its bounds,
+// then translated, parameters are updated by 'Update' before each frame
+class AnimatedShape : public Shape {
+public:
+    using Track = std::function<float(float)>;
+    using ColorTrack = std::function<color::SolidColor(float)>;
+
+    AnimatedShape(ShapePtr shape)
+            : shape_(shape), offset_x_(0.F), offset_y_(0.F),
+              radian_(0.F), scale_(1.F), cos_(1.F), sin_(0.F) {
+        color_ = shape_->color();
+        auto bounds = shape_->GetBounds();
+        pivot_x_ = bounds.center_x;
+        pivot_y_ = bounds.center_y;
+    }
+
+    // evaluate tracks at 'time', returns true if the shape is changed
+    bool Update(float time) {
+        auto changed = UpdateParam(offset_x_track_, time, offset_x_);
+        changed |= UpdateParam(offset_y_track_, time, offset_y_);
+        changed |= UpdateParam(scale_track_, time, scale_);
+        if (UpdateParam(rotation_track_, time, radian_)) {
+            cos_ = std::cos(radian_);
+            sin_ = std::sin(radian_);
+            changed = true;
+        }
+        if (color_track_) {
+            auto rgba = color_track_(time);
+            auto last = color_.GetColor();
+            if (!color_.is_solid() || rgba.red != last.red
+                    || rgba.green != last.green || rgba.blue != last.blue
+                    || rgba.alpha != last.alpha) {
+                color_ = rgba;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    float GetSDF(float x, float y) const override {
+        // map to the coordinate of operand
+        auto dx = x - pivot_x_ - offset_x_, dy = y - pivot_y_ - offset_y_;
+        auto lx = (dx * cos_ + dy * sin_) / scale_ + pivot_x_;
+        auto ly = (dy * cos_ - dx * sin_) / scale_ + pivot_y_;
+        return shape_->GetSDF(lx, ly) * scale_;
+    }
+
+    bool IsExact() const override {
+        return scale_ > 0.F && shape_->IsExact();
+    }
+
+    int GetNodeCount() const override { return 1 + shape_->GetNodeCount(); }
+
+    Bounds GetBounds() const override {
+        return shape_->GetBounds().Scale(pivot_x_, pivot_y_, scale_)
+                .Rotate(pivot_x_, pivot_y_, cos_, sin_)
+                .Offset(offset_x_, offset_y_);
+    }
+
+    Rect GetDrawArea() const override { return GetBounds().GetRect(); }
+
+    // scale must be positive
+    void set_offset_x(Track track) { offset_x_track_ = track; }
+    void set_offset_y(Track track) { offset_y_track_ = track; }
+    void set_rotation(Track track) { rotation_track_ = track; }
+    void set_scale(Track track) { scale_track_ = track; }
+    // gradients are not animated, the color becomes solid if set
+    void set_color_track(ColorTrack track) { color_track_ = track; }
+
+    const ShapePtr &shape() const { return shape_; }
+
+private:
+    static bool UpdateParam(const Track &track, float time, float &param) {
+        if (!track) return false;
+        auto value = track(time);
+        if (value == param) return false;
+        param = value;
+        return true;
+    }
+
+    ShapePtr shape_;
+    float pivot_x_, pivot_y_;
+    float offset_x_, offset_y_, radian_, scale_, cos_, sin_;
+    Track offset_x_track_, offset_y_track_, rotation_track_, scale_track_;
+    ColorTrack color_track_;
+};
+
+using AnimatedShapePtr = std::shared_ptr<AnimatedShape>;
+
+} // namespace cvf::shape
+
+#endif // CANVASFLAT_SHAPE_ANIMATED_H_
@@ -0,0 +1,328 @@
+#ifndef CANVASFLAT_SHAPE_BATCH_H_
+#define CANVASFLAT_SHAPE_BATCH_H_
+
+#include <vector>
+#include <cmath>
+#include <limits>
+
+#include "shape.h"
+#include "../util/mathutil.h"
+
+namespace cvf::shape {
+
+// batches of homogeneous primitives sharing one color
+// instances are stored as structure of arrays, 'GetSDFRow' walks the
+// instances that touch the row and updates a span of pixels per instance,
+// so the inner loop runs over contiguous floats without virtual calls
+//
+// pixels farther than 'kCullMargin' from every instance are not evaluated
+// in 'GetSDFRow', they get 'kCullMargin', which is still a lower bound
+// of the distance and large enough to be invisible
+// instances are also binned by rows, so that a row only visits
+// the instances which may touch it, & a single point visits bins
+// outward from its row until the rest can not be nearer
+//
+// instances can be blended by smooth union within distance 'blend',
+// in the order they are added, which fills the gaps between nearby
+// instances like a single organic shape, only instances within the
+// cull margin of a pixel are blended, so rows & single pixels agree
+class BatchShape : public Shape {
+public:
+    static constexpr float kCullMargin = 2.F;
+    static constexpr int kBinHeight = 16;
+
+    Rect GetDrawArea() const override {
+        if (empty()) return Rect(0, 0, -1, -1);
+        auto grow = blend_ / 4;
+        return Rect(std::floorf(left_ - grow), std::floorf(top_ - grow),
+                std::ceilf(right_ + grow), std::ceilf(bottom_ + grow));
+    }
+
+    // culled pixels get 'kCullMargin', which is still a lower bound,
+    // smooth union is not exact, but never changes faster than distance
+    bool IsExact() const override { return true; }
+
+    // smooth union moves the boundary outward by at most 'blend / 4'
+    Bounds GetBounds() const override {
+        if (empty()) return Bounds();
+        return Bounds(RectF(left_, top_, right_, bottom_)).Grow(blend_ / 4);
+    }
+
+    bool empty() const { return left_ > right_; }
+    float blend() const { return blend_; }
+
+protected:
+    BatchShape() : BatchShape(0.F) {}
+    // smooth union of instances farther than 'blend' plus the margin
+    // hardly changes distances less than the margin
+    BatchShape(float blend)
+            : left_(std::numeric_limits<float>::max()),
+              top_(std::numeric_limits<float>::max()),
+              right_(std::numeric_limits<float>::lowest()),
+              bottom_(std::numeric_limits<float>::lowest()),
+              blend_(util::Max(blend, 0.F)),
+              margin_(kCullMargin + blend_ * 3), bin_origin_(0) {}
+
+    // register the area of a newly added instance
+    void AddInstance(int index, float x0, float y0, float x1, float y1) {
+        left_ = util::Min(left_, x0);
+        top_ = util::Min(top_, y0);
+        right_ = util::Max(right_, x1);
+        bottom_ = util::Max(bottom_, y1);
+        // put instance into row bins
+        int first = std::floorf((y0 - margin_) / kBinHeight);
+        int last = std::floorf((y1 + margin_) / kBinHeight);
+        if (bins_.empty()) bin_origin_ = first;
+        if (first < bin_origin_) {
+            bins_.insert(bins_.begin(), bin_origin_ - first, {});
+            bin_origin_ = first;
+        }
+        if (last - bin_origin_ >= static_cast<int>(bins_.size())) {
+            bins_.resize(last - bin_origin_ + 1);
+        }
+        for (int i = first; i <= last; ++i) {
+            bins_[i - bin_origin_].push_back(index);
+        }
+    }
+
+    // get indices of instances which may touch row 'y'
+    const std::vector<int> &GetRowInstances(float y) const {
+        static const std::vector<int> empty_bin;
+        int bin = std::floorf(y / kBinHeight);
+        bin -= bin_origin_;
+        if (bin < 0 || bin >= static_cast<int>(bins_.size())) {
+            return empty_bin;
+        }
+        return bins_[bin];
+    }
+
+    // visit bins ring by ring from the bin of 'y', 'visit(bin, center)'
+    // returns the distance found so far, & 'center' tells the bin of
+    // 'y', which holds all instances not culled at 'y'
+    // instances out of rings 0 to k are farther than k bins plus the
+    // margin, so the rest is skipped once the distance is below that
+    template <typename Visit>
+    void VisitBins(float y, Visit visit) const {
+        int count = bins_.size();
+        if (!count) return;
+        int bin = std::floorf(y / kBinHeight);
+        bin -= bin_origin_;
+        int center = util::Min(util::Max(bin, 0), count - 1);
+        for (int k = 0; center - k >= 0 || center + k < count; ++k) {
+            auto dist = std::numeric_limits<float>::max();
+            if (center - k >= 0) {
+                dist = visit(bins_[center - k], !k && bin == center);
+            }
+            if (k && center + k < count) {
+                dist = visit(bins_[center + k], false);
+            }
+            if (dist <= k * kBinHeight + margin_) return;
+        }
+    }
+
+    // get the span of row pixels [first, last] affected by an instance
+    // which covers [x0, x1] horizontally, returns false if it's empty
+    bool GetSpan(float x, int count, float x0, float x1,
+            int &first, int &last) const {
+        first = util::Max(static_cast<int>(
+                std::ceilf(x0 - margin_ - x)), 0);
+        last = util::Min(static_cast<int>(
+                std::floorf(x1 + margin_ - x)), count - 1);
+        return first <= last;
+    }
+
+    // check if an instance which covers [x0, x1] x [y0, y1] is culled
+    // at pixel (x, y), the same as culled by rows
+    bool IsCulled(float x, float y, float x0, float y0,
+            float x1, float y1) const {
+        return x < x0 - margin_ || x > x1 + margin_
+                || y <= y0 - margin_ || y >= y1 + margin_;
+    }
+
+    // rows are initialized without instances, then instances are
+    // combined by 'Combine', & finished by 'FinishRow'
+    static void InitRow(int count, float *sdf) {
+        for (int i = 0; i < count; ++i) {
+            sdf[i] = std::numeric_limits<float>::max();
+        }
+    }
+
+    // union of distances, plain minimum if 'blend' is 0
+    float Combine(float sdf, float d) const {
+        return util::SmoothMin(sdf, d, blend_);
+    }
+
+    // distances are exact only below 'kCullMargin'
+    static void FinishRow(int count, float *sdf) {
+        for (int i = 0; i < count; ++i) {
+            sdf[i] = sdf[i] < kCullMargin ? sdf[i] : kCullMargin;
+        }
+    }
+
+    // distance from instances, out of which the instances are culled
+    float margin() const { return margin_; }
+
+private:
+    float left_, top_, right_, bottom_;
+    float blend_, margin_;
+    int bin_origin_;
+    std::vector<std::vector<int>> bins_;
+};
+
+class CircleBatch : public BatchShape {
+public:
+    CircleBatch() {}
+    CircleBatch(float blend) : BatchShape(blend) {}
+
+    int Add(float center_x, float center_y, float r) {
+        center_x_.push_back(center_x);
+        center_y_.push_back(center_y);
+        r_.push_back(r);
+        AddInstance(size() - 1, center_x - r, center_y - r,
+                center_x + r, center_y + r);
+        return size() - 1;
+    }
+
+    void Reserve(int count) {
+        center_x_.reserve(count);
+        center_y_.reserve(count);
+        r_.reserve(count);
+    }
+
+    float GetSDF(float x, float y) const override {
+        auto sdf = std::numeric_limits<float>::max(), far = sdf;
+        VisitBins(y, [&](const std::vector<int> &bin, bool center) {
+            for (auto i : bin) {
+                auto cx = center_x_[i], cy = center_y_[i], r = r_[i];
+                auto dx = x - cx, dy = y - cy;
+                auto d = std::sqrtf(dx * dx + dy * dy) - r;
+                // culled instances are not blended, like rows
+                if (!center || (blend() > 0.F && IsCulled(x, y,
+                        cx - r, cy - r, cx + r, cy + r))) {
+                    far = d < far ? d : far;
+                }
+                else {
+                    sdf = Combine(sdf, d);
+                }
+            }
+            return sdf < far ? sdf : far;
+        });
+        return sdf < far ? sdf : far;
+    }
+
+    void GetSDFRow(float x, float y, int count, float *sdf) const override {
+        InitRow(count, sdf);
+        for (auto i : GetRowInstances(y)) {
+            auto cx = center_x_[i], r = r_[i];
+            auto dy = y - center_y_[i];
+            if (std::fabsf(dy) >= r + margin()) continue;
+            int first, last;
+            if (!GetSpan(x, count, cx - r, cx + r, first, last)) continue;
+            auto dy2 = dy * dy, dx0 = x - cx;
+            for (int j = first; j <= last; ++j) {
+                auto dx = dx0 + j;
+                auto d = std::sqrtf(dx * dx + dy2) - r;
+                sdf[j] = Combine(sdf[j], d);
+            }
+        }
+        FinishRow(count, sdf);
+    }
+
+    int size() const { return r_.size(); }
+
+private:
+    std::vector<float> center_x_, center_y_, r_;
+};
+
+class CapsuleBatch : public BatchShape {
+public:
+    CapsuleBatch() {}
+    CapsuleBatch(float blend) : BatchShape(blend) {}
+
+    int Add(float x0, float y0, float x1, float y1, float r) {
+        x0_.push_back(x0);
+        y0_.push_back(y0);
+        dx_.push_back(x1 - x0);
+        dy_.push_back(y1 - y0);
+        auto len2 = (x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0);
+        inv_len2_.push_back(len2 > 0.F ? 1.F / len2 : 0.F);
+        r_.push_back(r);
+        AddInstance(size() - 1,
+                util::Min(x0, x1) - r, util::Min(y0, y1) - r,
+                util::Max(x0, x1) + r, util::Max(y0, y1) + r);
+        return size() - 1;
+    }
+
+    void Reserve(int count) {
+        for (auto v : {&x0_, &y0_, &dx_, &dy_, &inv_len2_, &r_}) {
+            v->reserve(count);
+        }
+    }
+
+    float GetSDF(float x, float y) const override {
+        auto sdf = std::numeric_limits<float>::max(), far = sdf;
+        VisitBins(y, [&](const std::vector<int> &bin, bool center) {
+            for (auto i : bin) {
+                auto x0 = x0_[i], y0 = y0_[i], r = r_[i];
+                auto x1 = x0 + dx_[i], y1 = y0 + dy_[i];
+                auto d = GetInstanceSDF(i, x - x0, y - y0);
+                // culled instances are not blended, like rows
+                if (!center || (blend() > 0.F && IsCulled(x, y,
+                        util::Min(x0, x1) - r, util::Min(y0, y1) - r,
+                        util::Max(x0, x1) + r, util::Max(y0, y1) + r))) {
+                    far = d < far ? d : far;
+                }
+                else {
+                    sdf = Combine(sdf, d);
+                }
+            }
+            return sdf < far ? sdf : far;
+        });
+        return sdf < far ? sdf : far;
+    }
+
+    void GetSDFRow(float x, float y, int count, float *sdf) const override {
+        InitRow(count, sdf);
+        for (auto i : GetRowInstances(y)) {
+            auto x0 = x0_[i], x1 = x0 + dx_[i], r = r_[i];
+            auto ey0 = y0_[i], ey1 = ey0 + dy_[i];
+            if (y <= util::Min(ey0, ey1) - r - margin()
+                    || y >= util::Max(ey0, ey1) + r + margin()) {
+                continue;
+            }
+            int first, last;
+            if (!GetSpan(x, count, util::Min(x0, x1) - r,
+                    util::Max(x0, x1) + r, first, last)) {
+                continue;
+            }
+            auto ddx = dx_[i], ddy = dy_[i], inv = inv_len2_[i];
+            auto py = y - ey0, px0 = x - x0;
+            for (int j = first; j <= last; ++j) {
+                auto px = px0 + j;
+                auto h = (px * ddx + py * ddy) * inv;
+                h = h < 0.F ? 0.F : (h > 1.F ? 1.F : h);
+                auto dx = px - ddx * h, dy = py - ddy * h;
+                auto d = std::sqrtf(dx * dx + dy * dy) - r;
+                sdf[j] = Combine(sdf[j], d);
+            }
+        }
+        FinishRow(count, sdf);
+    }
+
+    int size() const { return r_.size(); }
+
+private:
+    float GetInstanceSDF(int i, float px, float py) const {
+        auto h = (px * dx_[i] + py * dy_[i]) * inv_len2_[i];
+        h = h < 0.F ? 0.F : (h > 1.F ? 1.F : h);
+        auto dx = px - dx_[i] * h, dy = py - dy_[i] * h;
+        return std::sqrtf(dx * dx + dy * dy) - r_[i];
+    }
+
+    // start point, direction vector and its inversed squared length
+    std::vector<float> x0_, y0_, dx_, dy_, inv_len2_, r_;
+};
+
+} // namespace cvf::shape
+
+#endif // CANVASFLAT_SHAPE_BATCH_H_
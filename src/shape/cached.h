@@ -0,0 +1,223 @@
+#ifndef CANVASFLAT_SHAPE_CACHED_H_
+#define CANVASFLAT_SHAPE_CACHED_H_
+
+#include <cstddef>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <list>
+#include <mutex>
+
+#include "shape.h"
+#include "../util/mathutil.h"
+
+namespace cvf::shape {
+
+// SDF of a shape sampled on a regular grid
+class SDFField {
+public:
+    // margin of grid around the draw area, in pixels
+    static constexpr float kMargin = 2.F;
+
+    // 'resolution' is the count of samples per pixel
+    SDFField(const Shape &shape, float resolution)
+            : resolution_(resolution) {
+        auto area = shape.GetDrawArea();
+        left_ = area.left - kMargin;
+        top_ = area.top - kMargin;
+        right_ = area.right + kMargin;
+        bottom_ = area.bottom + kMargin;
+        cols_ = std::ceilf((right_ - left_) * resolution) + 1;
+        rows_ = std::ceilf((bottom_ - top_) * resolution) + 1;
+        right_ = left_ + (cols_ - 1) / resolution;
+        bottom_ = top_ + (rows_ - 1) / resolution;
+        field_.resize(cols_ * rows_);
+        for (int y = 0; y < rows_; ++y) {
+            for (int x = 0; x < cols_; ++x) {
+                field_[y * cols_ + x] = shape.GetSDF(
+                        left_ + x / resolution, top_ + y / resolution);
+            }
+        }
+    }
+
+    // bilinear lookup, points outside the grid are clamped to the grid
+    // and their distance to it is added
+    float Sample(float x, float y) const {
+        auto cx = util::Max(util::Min(x, right_), left_);
+        auto cy = util::Max(util::Min(y, bottom_), top_);
+        auto fx = (cx - left_) * resolution_;
+        auto fy = (cy - top_) * resolution_;
+        int ix = util::Min(static_cast<int>(fx), cols_ - 2);
+        int iy = util::Min(static_cast<int>(fy), rows_ - 2);
+        fx -= ix;
+        fy -= iy;
+        auto p = field_.data() + iy * cols_ + ix;
+        auto top = p[0] + (p[1] - p[0]) * fx;
+        auto bottom = p[cols_] + (p[cols_ + 1] - p[cols_]) * fx;
+        auto sdf = top + (bottom - top) * fy;
+        if (cx != x || cy != y) {
+            auto dx = x - cx, dy = y - cy;
+            sdf += std::sqrtf(dx * dx + dy * dy);
+        }
+        return sdf;
+    }
+
+    // lookup a row of pixels, the vertical interpolation is done once
+    // for the whole row and the span inside the grid is branch free
+    void SampleRow(float x, float y, int count, float *sdf) const {
+        if (y < top_ || y > bottom_) {
+            for (int i = 0; i < count; ++i) sdf[i] = Sample(x + i, y);
+            return;
+        }
+        auto fy = (y - top_) * resolution_;
+        int iy = util::Min(static_cast<int>(fy), rows_ - 2);
+        fy -= iy;
+        auto p0 = field_.data() + iy * cols_, p1 = p0 + cols_;
+        // pixels inside the grid
+        int first = util::Max(static_cast<int>(std::ceilf(left_ - x)), 0);
+        int last = util::Min(static_cast<int>(std::floorf(right_ - x)),
+                count - 1);
+        for (int i = 0; i < first && i < count; ++i) sdf[i] = Sample(x + i, y);
+        for (int i = first; i <= last; ++i) {
+            auto fx = (x + i - left_) * resolution_;
+            int ix = util::Min(static_cast<int>(fx), cols_ - 2);
+            fx -= ix;
+            auto top = p0[ix] + (p0[ix + 1] - p0[ix]) * fx;
+            auto bottom = p1[ix] + (p1[ix + 1] - p1[ix]) * fx;
+            sdf[i] = top + (bottom - top) * fy;
+        }
+        for (int i = util::Max(last + 1, first); i < count; ++i) {
+            sdf[i] = Sample(x + i, y);
+        }
+    }
+
+    std::size_t bytes() const { return field_.size() * sizeof(float); }
+    float resolution() const { return resolution_; }
+
+private:
+    float resolution_, left_, top_, right_, bottom_;
+    int cols_, rows_;
+    std::vector<float> field_;
+};
+
+using SDFFieldPtr = std::shared_ptr<const SDFField>;
+
+// global cache of sampled fields, keyed by the identity of shape tree
+// and sampling resolution, least recently used fields are dropped
+// when the total size exceeds the memory budget
+class FieldCache {
+public:
+    static FieldCache &Get() {
+        static FieldCache cache;
+        return cache;
+    }
+
+    // fields are sampled outside the lock, so other shapes are not held
+    // up, if two threads sample the same shape the first field is kept
+    SDFFieldPtr Acquire(const ShapePtr &shape, float resolution) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (auto field = Find(shape, resolution)) return field;
+        }
+        auto field = std::make_shared<const SDFField>(*shape, resolution);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (auto first = Find(shape, resolution)) return first;
+        entries_.push_front({shape, resolution, field});
+        used_ += field->bytes();
+        Shrink();
+        return field;
+    }
+
+    void Clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        used_ = 0;
+    }
+
+    void set_budget(std::size_t budget) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        budget_ = budget;
+        Shrink();
+    }
+
+    std::size_t budget() const { return budget_; }
+    std::size_t used() const { return used_; }
+
+private:
+    struct Entry {
+        std::weak_ptr<const Shape> shape;
+        float resolution;
+        SDFFieldPtr field;
+    };
+
+    FieldCache() : used_(0), budget_(64 << 20) {}
+
+    // field of the shape & move it to front, the lock must be held
+    SDFFieldPtr Find(const ShapePtr &shape, float resolution) {
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->shape.lock() == shape && it->resolution == resolution) {
+                entries_.splice(entries_.begin(), entries_, it);
+                return it->field;
+            }
+        }
+        return nullptr;
+    }
+
+    void Shrink() {
+        // drop expired shapes first, then the least recently used ones
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (it->shape.expired()) {
+                used_ -= it->field->bytes();
+                it = entries_.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        while (used_ > budget_ && !entries_.empty()) {
+            used_ -= entries_.back().field->bytes();
+            entries_.pop_back();
+        }
+    }
+
+    std::mutex mutex_;
+    std::list<Entry> entries_;
+    std::size_t used_, budget_;
+};
+
+// shape whose SDF is answered by a precomputed field of another shape,
+// fields are shared through 'FieldCache', so static shapes drawn in many
+// frames or at many offsets are only sampled once
+class CachedShape : public Shape {
+public:
+    CachedShape(ShapePtr shape) : CachedShape(shape, 1.F) {}
+    CachedShape(ShapePtr shape, float resolution)
+            : shape_(shape),
+              field_(FieldCache::Get().Acquire(shape, resolution)) {
+        color_ = shape_->color();
+    }
+
+    float GetSDF(float x, float y) const override {
+        return field_->Sample(x, y);
+    }
+
+    void GetSDFRow(float x, float y, int count, float *sdf) const override {
+        field_->SampleRow(x, y, count, sdf);
+    }
+
+    Rect GetDrawArea() const override {
+        return shape_->GetDrawArea();
+    }
+
+    Bounds GetBounds() const override { return shape_->GetBounds(); }
+
+    const ShapePtr &shape() const { return shape_; }
+
+private:
+    ShapePtr shape_;
+    SDFFieldPtr field_;
+};
+
+} // namespace cvf::shape
+
+#endif // CANVASFLAT_SHAPE_CACHED_H_
@@ -4,6 +4,8 @@
 #include <cmath>
 
 #include "shape.h"
+#include "../util/mathutil.h"
+#include "../util/fastmath.h"
 
 namespace cvf::shape {
 
@@ -13,11 +15,49 @@ public:
             : x0_(x0), y0_(y0), x1_(x1), y1_(y1), r_(r) {}
 
     float GetSDF(float x, float y) const override {
+        return util::WithMath([&](auto math) { return GetSDF(math, x, y); });
+    }
+
+    void GetSDFRow(float x, float y, int count, float *sdf) const override {
+        util::WithMath([&](auto math) {
+            for (int i = 0; i < count; ++i) sdf[i] = GetSDF(math, x + i, y);
+        });
+    }
+
+    // SDF using math functions of 'Math'
+    template <typename Math>
+    float GetSDF(Math, float x, float y) const {
+        auto dx0 = x - x0_, dy0 = y - y0_, dx1 = x1_ - x0_, dy1 = y1_ - y0_;
+        auto h = (dx0 * dx1 + dy0 * dy1) / (dx1 * dx1 + dy1 * dy1);
+        h = h < 1.F ? (h > 0.F ? h : 0.F) : 1.F;
+        auto dx = dx0 - dx1 * h, dy = dy0 - dy1 * h;
+        return Math::Sqrt(dx * dx + dy * dy) - r_;
+    }
+
+    // the boundary is treated as a straight edge inside the pixel,
+    // which is exact on the sides and a close estimate on the caps
+    float GetCoverage(const RectF &pixel) const override {
+        auto x = pixel.center_x(), y = pixel.center_y();
         auto dx0 = x - x0_, dy0 = y - y0_, dx1 = x1_ - x0_, dy1 = y1_ - y0_;
         auto h = (dx0 * dx1 + dy0 * dy1) / (dx1 * dx1 + dy1 * dy1);
         h = std::fmaxf(std::fminf(h, 1.F), 0.F);
         auto dx = dx0 - dx1 * h, dy = dy0 - dy1 * h;
-        return std::sqrtf(dx * dx + dy * dy) - r_;
+        auto len = util::Sqrt(dx * dx + dy * dy);
+        if (len <= 0.F) return 1.F;
+        auto u = std::fabsf(dx / len) * pixel.width() / 2;
+        auto v = std::fabsf(dy / len) * pixel.height() / 2;
+        return util::EdgeCoverage(len - r_, u, v);
+    }
+
+    bool IsExact() const override { return true; }
+
+    // box along the segment
+    Bounds GetBounds() const override {
+        auto dx = x1_ - x0_, dy = y1_ - y0_;
+        auto len = std::sqrt(dx * dx + dy * dy);
+        auto c = len > 0.F ? dx / len : 1.F, s = len > 0.F ? dy / len : 0.F;
+        return Bounds((x0_ + x1_) / 2, (y0_ + y1_) / 2, len / 2 + r_, r_,
+                c, s);
     }
 
     Rect GetDrawArea() const override {
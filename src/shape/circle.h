@@ -4,6 +4,8 @@
 #include <cmath>
 
 #include "shape.h"
+#include "../util/mathutil.h"
+#include "../util/fastmath.h"
 
 namespace cvf::shape {
 
@@ -13,8 +15,38 @@ public:
             : center_x_(center_x), center_y_(center_y), r_(r) {}
 
     float GetSDF(float x, float y) const override {
+        return util::WithMath([&](auto math) { return GetSDF(math, x, y); });
+    }
+
+    void GetSDFRow(float x, float y, int count, float *sdf) const override {
+        util::WithMath([&](auto math) {
+            for (int i = 0; i < count; ++i) sdf[i] = GetSDF(math, x + i, y);
+        });
+    }
+
+    // SDF using math functions of 'Math'
+    template <typename Math>
+    float GetSDF(Math, float x, float y) const {
         auto dx = x - center_x_, dy = y - center_y_;
-        return std::sqrtf(dx * dx + dy * dy) - r_;
+        return Math::Sqrt(dx * dx + dy * dy) - r_;
+    }
+
+    // exact area of intersection of the circle and pixel
+    float GetCoverage(const RectF &pixel) const override {
+        auto sdf = GetSDF(pixel.center_x(), pixel.center_y());
+        auto w = pixel.width(), h = pixel.height();
+        auto half_diag = util::Sqrt(w * w + h * h) / 2;
+        if (sdf >= half_diag) return 0.F;
+        if (sdf <= -half_diag) return 1.F;
+        auto area = GetArea(pixel.left - center_x_, pixel.right - center_x_,
+                pixel.top - center_y_, pixel.bottom - center_y_);
+        return util::Min(static_cast<float>(area / (w * h)), 1.F);
+    }
+
+    bool IsExact() const override { return true; }
+
+    Bounds GetBounds() const override {
+        return Bounds(center_x_, center_y_, r_, r_);
     }
 
     Rect GetDrawArea() const override {
@@ -26,6 +58,30 @@ public:
     }
 
 private:
+    // integral of (sqrt(r^2 - x^2) - h) dx
+    double GetIntegral(double x, double h) const {
+        double r = r_, k = util::Max(util::Min(x / r, 1.), -1.);
+        return 0.5 * (x * std::sqrt(r * r - x * x) + r * r * std::asin(k))
+                - h * x;
+    }
+
+    // area of circle in [x0, x1] and above line y = h (h >= 0)
+    double GetArea(double x0, double x1, double h) const {
+        double r = r_, s = h < r ? std::sqrt(r * r - h * h) : 0.;
+        x0 = util::Max(util::Min(x0, s), -s);
+        x1 = util::Max(util::Min(x1, s), -s);
+        return GetIntegral(x1, h) - GetIntegral(x0, h);
+    }
+
+    // area of circle in rectangle [x0, x1] * [y0, y1], relative to center
+    double GetArea(double x0, double x1, double y0, double y1) const {
+        if (y0 < 0) {
+            if (y1 < 0) return GetArea(x0, x1, -y1, -y0);
+            return GetArea(x0, x1, 0, -y0) + GetArea(x0, x1, 0, y1);
+        }
+        return GetArea(x0, x1, y0) - GetArea(x0, x1, y1);
+    }
+
     float center_x_, center_y_, r_;
 };
 
@@ -0,0 +1,477 @@
+#ifndef CANVASFLAT_SHAPE_EXPR_H_
+#define CANVASFLAT_SHAPE_EXPR_H_
+
+#include <cmath>
+#include <memory>
+
+#include "shape.h"
+#include "circle.h"
+#include "rectangle.h"
+#include "capsule.h"
+#include "squircle.h"
+#include "../util/mathutil.h"
+#include "../util/fastmath.h"
+
+// compile-time shape composition
+// scenes known at compile time can be written as expression templates,
+// e.g. 'MakeRound(Rectangle(0, 0, 10), 2) | Circle(5, 5, 8)', the SDF
+// is then a single inlined function without virtual calls, and only the
+// root is type-erased into a 'Shape' by 'MakeShape'
+// semantics of all nodes are identical to 'Operation'
+namespace cvf::shape::expr {
+
+// base of all expressions
+template <typename Derived>
+class Expr {
+public:
+    const Derived &self() const {
+        return static_cast<const Derived &>(*this);
+    }
+};
+
+// leaf node, wraps a concrete primitive shape, SDF comes from its kernel
+// template & other member functions are called with qualified names,
+// so no virtual dispatch is involved
+template <typename T>
+class Primitive : public Expr<Primitive<T>> {
+public:
+    Primitive(const T &shape) : shape_(shape) {}
+
+    template <typename Math>
+    float GetSDF(Math math, float x, float y) const {
+        return shape_.GetSDF(math, x, y);
+    }
+    Rect GetDrawArea() const { return shape_.T::GetDrawArea(); }
+    Bounds GetBounds() const { return shape_.T::GetBounds(); }
+    bool IsExact() const { return shape_.T::IsExact(); }
+    int GetNodeCount() const { return 1; }
+
+private:
+    T shape_;
+};
+
+// helpers, plain comparisons can be inlined & vectorized
+inline float MinF(float a, float b) { return a < b ? a : b; }
+inline float MaxF(float a, float b) { return a > b ? a : b; }
+
+template <typename A, typename B>
+class Union : public Expr<Union<A, B>> {
+public:
+    Union(const A &a, const B &b) : a_(a), b_(b) {}
+
+    template <typename Math>
+    float GetSDF(Math math, float x, float y) const {
+        return MinF(a_.GetSDF(math, x, y), b_.GetSDF(math, x, y));
+    }
+
+    Rect GetDrawArea() const { return GetBounds().GetRect(); }
+    Bounds GetBounds() const {
+        return Bounds::Union(a_.GetBounds(), b_.GetBounds());
+    }
+
+    bool IsExact() const { return a_.IsExact() && b_.IsExact(); }
+    int GetNodeCount() const {
+        return 1 + a_.GetNodeCount() + b_.GetNodeCount();
+    }
+
+private:
+    A a_;
+    B b_;
+};
+
+template <typename A, typename B>
+class Intersection : public Expr<Intersection<A, B>> {
+public:
+    Intersection(const A &a, const B &b) : a_(a), b_(b) {}
+
+    template <typename Math>
+    float GetSDF(Math math, float x, float y) const {
+        return MaxF(a_.GetSDF(math, x, y), b_.GetSDF(math, x, y));
+    }
+
+    Rect GetDrawArea() const { return GetBounds().GetRect(); }
+    Bounds GetBounds() const {
+        return Bounds::Intersection(a_.GetBounds(), b_.GetBounds());
+    }
+
+    bool IsExact() const { return a_.IsExact() && b_.IsExact(); }
+    int GetNodeCount() const {
+        return 1 + a_.GetNodeCount() + b_.GetNodeCount();
+    }
+
+private:
+    A a_;
+    B b_;
+};
+
+template <typename A, typename B>
+class Difference : public Expr<Difference<A, B>> {
+public:
+    Difference(const A &a, const B &b) : a_(a), b_(b) {}
+
+    template <typename Math>
+    float GetSDF(Math math, float x, float y) const {
+        return MaxF(a_.GetSDF(math, x, y), -b_.GetSDF(math, x, y));
+    }
+
+    Rect GetDrawArea() const { return GetBounds().GetRect(); }
+    Bounds GetBounds() const { return a_.GetBounds(); }
+
+    bool IsExact() const { return a_.IsExact() && b_.IsExact(); }
+    int GetNodeCount() const {
+        return 1 + a_.GetNodeCount() + b_.GetNodeCount();
+    }
+
+private:
+    A a_;
+    B b_;
+};
+
+// base of boolean operations blended within distance 'k'
+template <typename A, typename B, typename Derived>
+class SmoothExpr : public Expr<Derived> {
+public:
+    Rect GetDrawArea() const {
+        return static_cast<const Derived *>(this)->GetBounds().GetRect();
+    }
+    bool IsExact() const { return a_.IsExact() && b_.IsExact(); }
+    int GetNodeCount() const {
+        return 1 + a_.GetNodeCount() + b_.GetNodeCount();
+    }
+
+protected:
+    SmoothExpr(const A &a, const B &b, float k) : a_(a), b_(b), k_(k) {}
+
+    A a_;
+    B b_;
+    float k_;
+};
+
+template <typename A>
+class Blur;
+
+// exact SDF which keeps growing away from the shape, see 'Operation'
+template <typename T>
+bool IsDistance(const T &e) { return e.IsExact(); }
+template <typename A>
+bool IsDistance(const Blur<A> &) { return false; }
+
+template <typename A, typename B>
+class SmoothUnion : public SmoothExpr<A, B, SmoothUnion<A, B>> {
+public:
+    SmoothUnion(const A &a, const B &b, float k)
+            : SmoothExpr<A, B, SmoothUnion<A, B>>(a, b, k) {}
+
+    template <typename Math>
+    float GetSDF(Math math, float x, float y) const {
+        return util::SmoothMin(this->a_.GetSDF(math, x, y),
+                this->b_.GetSDF(math, x, y), this->k_);
+    }
+
+    Bounds GetBounds() const {
+        auto grow = IsDistance(this->a_) && IsDistance(this->b_)
+                ? this->k_ / 4 : this->k_;
+        return Bounds::Union(this->a_.GetBounds(),
+                this->b_.GetBounds()).Grow(grow);
+    }
+};
+
+template <typename A, typename B>
+class SmoothIntersection
+        : public SmoothExpr<A, B, SmoothIntersection<A, B>> {
+public:
+    SmoothIntersection(const A &a, const B &b, float k)
+            : SmoothExpr<A, B, SmoothIntersection<A, B>>(a, b, k) {}
+
+    template <typename Math>
+    float GetSDF(Math math, float x, float y) const {
+        return util::SmoothMax(this->a_.GetSDF(math, x, y),
+                this->b_.GetSDF(math, x, y), this->k_);
+    }
+
+    Bounds GetBounds() const {
+        return Bounds::Intersection(this->a_.GetBounds(),
+                this->b_.GetBounds());
+    }
+};
+
+template <typename A, typename B>
+class SmoothDifference : public SmoothExpr<A, B, SmoothDifference<A, B>> {
+public:
+    SmoothDifference(const A &a, const B &b, float k)
+            : SmoothExpr<A, B, SmoothDifference<A, B>>(a, b, k) {}
+
+    template <typename Math>
+    float GetSDF(Math math, float x, float y) const {
+        return util::SmoothMax(this->a_.GetSDF(math, x, y),
+                -this->b_.GetSDF(math, x, y), this->k_);
+    }
+
+    Bounds GetBounds() const { return this->a_.GetBounds(); }
+};
+
+// base of unary nodes which act around the center of operand
+template <typename A, typename Derived>
+class UnaryExpr : public Expr<Derived> {
+public:
+    Rect GetDrawArea() const {
+        return static_cast<const Derived *>(this)->GetBounds().GetRect();
+    }
+    bool IsExact() const { return a_.IsExact(); }
+    int GetNodeCount() const { return 1 + a_.GetNodeCount(); }
+
+protected:
+    UnaryExpr(const A &a, float param) : a_(a), param_(param) {
+        auto area = a_.GetDrawArea();
+        center_x_ = area.left + (area.right - area.left) / 2;
+        center_y_ = area.top + (area.bottom - area.top) / 2;
+    }
+
+    A a_;
+    float param_, center_x_, center_y_;
+};
+
+template <typename A>
+class Round : public UnaryExpr<A, Round<A>> {
+public:
+    Round(const A &a, float r) : UnaryExpr<A, Round<A>>(a, r) {}
+
+    template <typename Math>
+    float GetSDF(Math math, float x, float y) const {
+        return this->a_.GetSDF(math, x, y) - this->param_;
+    }
+
+    Bounds GetBounds() const {
+        return this->a_.GetBounds().Grow(this->param_);
+    }
+};
+
+template <typename A>
+class Outline : public UnaryExpr<A, Outline<A>> {
+public:
+    Outline(const A &a, float width) : UnaryExpr<A, Outline<A>>(a, width) {}
+
+    template <typename Math>
+    float GetSDF(Math math, float x, float y) const {
+        auto sdf = this->a_.GetSDF(math, x, y), half = this->param_ / 2;
+        return MaxF(sdf - half, -(sdf + half));
+    }
+
+    Bounds GetBounds() const {
+        return this->a_.GetBounds().Grow(this->param_ / 2);
+    }
+};
+
+template <typename A>
+class Blur : public UnaryExpr<A, Blur<A>> {
+public:
+    Blur(const A &a, float radius) : UnaryExpr<A, Blur<A>>(a, radius) {}
+
+    template <typename Math>
+    float GetSDF(Math math, float x, float y) const {
+        auto sdf = this->a_.GetSDF(math, x, y);
+        return util::LinearMapping(sdf, -0.5F * this->param_, 0.5F,
+                -0.5F, 0.5F);
+    }
+
+    Bounds GetBounds() const { return this->a_.GetBounds(); }
+    bool IsExact() const {
+        return this->param_ >= 1.F && this->a_.IsExact();
+    }
+};
+
+template <typename A>
+class Offset : public Expr<Offset<A>> {
+public:
+    Offset(const A &a, float dx, float dy) : a_(a), dx_(dx), dy_(dy) {}
+
+    template <typename Math>
+    float GetSDF(Math math, float x, float y) const {
+        return a_.GetSDF(math, x - dx_, y - dy_);
+    }
+
+    bool IsExact() const { return a_.IsExact(); }
+    int GetNodeCount() const { return 1 + a_.GetNodeCount(); }
+
+    Rect GetDrawArea() const { return GetBounds().GetRect(); }
+    Bounds GetBounds() const { return a_.GetBounds().Offset(dx_, dy_); }
+
+private:
+    A a_;
+    float dx_, dy_;
+};
+
+template <typename A>
+class Scale : public UnaryExpr<A, Scale<A>> {
+public:
+    Scale(const A &a, float k) : UnaryExpr<A, Scale<A>>(a, k) {}
+
+    template <typename Math>
+    float GetSDF(Math math, float x, float y) const {
+        auto cx = this->center_x_, cy = this->center_y_, k = this->param_;
+        return this->a_.GetSDF(math, (x - cx) / k + cx, (y - cy) / k + cy) * k;
+    }
+
+    bool IsExact() const {
+        return this->param_ > 0.F && this->a_.IsExact();
+    }
+
+    Bounds GetBounds() const {
+        return this->a_.GetBounds().Scale(this->center_x_, this->center_y_,
+                this->param_);
+    }
+};
+
+template <typename A>
+class Rotate : public UnaryExpr<A, Rotate<A>> {
+public:
+    Rotate(const A &a, float radian)
+            : UnaryExpr<A, Rotate<A>>(a, radian),
+              cos_(std::cos(radian)), sin_(std::sin(radian)) {}
+
+    template <typename Math>
+    float GetSDF(Math math, float x, float y) const {
+        auto dx = x - this->center_x_, dy = y - this->center_y_;
+        return this->a_.GetSDF(math, dx * cos_ + dy * sin_ + this->center_x_,
+                -dx * sin_ + dy * cos_ + this->center_y_);
+    }
+
+    Bounds GetBounds() const {
+        return this->a_.GetBounds().Rotate(this->center_x_, this->center_y_,
+                cos_, sin_);
+    }
+
+private:
+    float cos_, sin_;
+};
+
+// primitives
+inline Primitive<::cvf::shape::Circle> Circle(float center_x,
+        float center_y, float r) {
+    return ::cvf::shape::Circle(center_x, center_y, r);
+}
+
+inline Primitive<::cvf::shape::Rectangle> Rectangle(float x0, float y0,
+        float width, float height) {
+    return ::cvf::shape::Rectangle(x0, y0, width, height);
+}
+
+inline Primitive<::cvf::shape::Rectangle> Rectangle(float x0, float y0,
+        float side) {
+    return ::cvf::shape::Rectangle(x0, y0, side);
+}
+
+inline Primitive<::cvf::shape::Capsule> Capsule(float x0, float y0,
+        float x1, float y1, float r) {
+    return ::cvf::shape::Capsule(x0, y0, x1, y1, r);
+}
+
+inline Primitive<::cvf::shape::Squircle> Squircle(float center_x,
+        float center_y, float r, int order) {
+    return ::cvf::shape::Squircle(center_x, center_y, r, order);
+}
+
+// operators & functions building nodes
+template <typename A, typename B>
+inline Union<A, B> operator|(const Expr<A> &a, const Expr<B> &b) {
+    return Union<A, B>(a.self(), b.self());
+}
+
+template <typename A, typename B>
+inline Intersection<A, B> operator&(const Expr<A> &a, const Expr<B> &b) {
+    return Intersection<A, B>(a.self(), b.self());
+}
+
+template <typename A, typename B>
+inline Difference<A, B> operator-(const Expr<A> &a, const Expr<B> &b) {
+    return Difference<A, B>(a.self(), b.self());
+}
+
+template <typename A, typename B>
+inline SmoothUnion<A, B> MakeSmoothUnion(const Expr<A> &a,
+        const Expr<B> &b, float k) {
+    return SmoothUnion<A, B>(a.self(), b.self(), k);
+}
+
+template <typename A, typename B>
+inline SmoothIntersection<A, B> MakeSmoothIntersection(const Expr<A> &a,
+        const Expr<B> &b, float k) {
+    return SmoothIntersection<A, B>(a.self(), b.self(), k);
+}
+
+template <typename A, typename B>
+inline SmoothDifference<A, B> MakeSmoothDifference(const Expr<A> &a,
+        const Expr<B> &b, float k) {
+    return SmoothDifference<A, B>(a.self(), b.self(), k);
+}
+
+template <typename A>
+inline Round<A> MakeRound(const Expr<A> &a, float r) {
+    return Round<A>(a.self(), r);
+}
+
+template <typename A>
+inline Outline<A> MakeOutline(const Expr<A> &a, float width) {
+    return Outline<A>(a.self(), width);
+}
+
+template <typename A>
+inline Blur<A> MakeBlur(const Expr<A> &a, float radius) {
+    return Blur<A>(a.self(), radius);
+}
+
+template <typename A>
+inline Offset<A> MakeOffset(const Expr<A> &a, float dx, float dy) {
+    return Offset<A>(a.self(), dx, dy);
+}
+
+template <typename A>
+inline Scale<A> MakeScale(const Expr<A> &a, float k) {
+    return Scale<A>(a.self(), k);
+}
+
+template <typename A>
+inline Rotate<A> MakeRotate(const Expr<A> &a, float radian) {
+    return Rotate<A>(a.self(), radian);
+}
+
+// type-erased adapter of the root of an expression
+template <typename E>
+class ExprShape : public Shape {
+public:
+    ExprShape(const E &expr) : expr_(expr) {}
+
+    float GetSDF(float x, float y) const override {
+        return util::WithMath([&](auto math) {
+            return expr_.GetSDF(math, x, y);
+        });
+    }
+
+    // precision is chosen once, the whole tree is inlined into the loop
+    void GetSDFRow(float x, float y, int count, float *sdf) const override {
+        util::WithMath([&](auto math) {
+            for (int i = 0; i < count; ++i) {
+                sdf[i] = expr_.GetSDF(math, x + i, y);
+            }
+        });
+    }
+
+    Rect GetDrawArea() const override { return expr_.GetDrawArea(); }
+    Bounds GetBounds() const override { return expr_.GetBounds(); }
+    bool IsExact() const override { return expr_.IsExact(); }
+    int GetNodeCount() const override { return expr_.GetNodeCount(); }
+
+    const E &expr() const { return expr_; }
+
+private:
+    E expr_;
+};
+
+template <typename E>
+inline ShapePtr MakeShape(const Expr<E> &expr) {
+    return std::make_shared<ExprShape<E>>(expr.self());
+}
+
+} // namespace cvf::shape::expr
+
+#endif // CANVASFLAT_SHAPE_EXPR_H_
@@ -0,0 +1,150 @@
+#ifndef CANVASFLAT_SHAPE_LAYER_H_
+#define CANVASFLAT_SHAPE_LAYER_H_
+
+#include <limits>
+#include <memory>
+#include <vector>
+#include <utility>
+
+#include "shape.h"
+#include "operation.h"
+#include "../color/color.h"
+#include "../color/format.h"
+#include "../render/basic.h"
+#include "../util/mathutil.h"
+
+namespace cvf::shape {
+
+// group of shapes rendered once into a premultiplied RGBA8 buffer,
+// which covers the union of their draw areas, the buffer is composited
+// with opacity & offset in place of the shapes, & is rendered again
+// only on the next draw after 'Invalidate'
+// the buffer is rendered lazily, so a layer must not be drawn by
+// several threads before it's ready
+class Layer : public Shape {
+public:
+    Layer() : opacity_(1.F), offset_x_(0), offset_y_(0), valid_(false) {
+        auto render = std::make_unique<render::BasicRender>();
+        render->set_anti_aliasing(true);
+        render_ = std::move(render);
+    }
+    Layer(const ShapeList &shapes) : Layer() { shapes_ = shapes; }
+
+    int AddShape(const ShapePtr &shape) {
+        valid_ = false;
+        shapes_.push_back(shape);
+        return shapes_.size() - 1;
+    }
+    void ClearShape() {
+        valid_ = false;
+        shapes_.clear();
+    }
+
+    // render the buffer again before next draw,
+    // must be called after any shape of layer is changed
+    void Invalidate() { valid_ = false; }
+
+    // SDF of the union of shapes, used when layer is an operand
+    float GetSDF(float x, float y) const override {
+        auto sdf = std::numeric_limits<float>::max();
+        for (const auto &shape : shapes_) {
+            sdf = util::Min(sdf, shape->GetSDF(x - offset_x_,
+                    y - offset_y_));
+        }
+        return sdf;
+    }
+
+    Rect GetDrawArea() const override {
+        Update();
+        if (area_.left > area_.right) return area_;
+        return Rect(area_.left + offset_x_, area_.top + offset_y_,
+                area_.right + offset_x_, area_.bottom + offset_y_);
+    }
+
+    int GetNodeCount() const override {
+        int count = 0;
+        for (const auto &shape : shapes_) count += shape->GetNodeCount();
+        return count;
+    }
+
+    bool GetRaster(Raster &raster) const override {
+        Update();
+        if (area_.left > area_.right) return false;
+        raster.pixels = buffer_.data();
+        raster.area = GetDrawArea();
+        raster.opacity = opacity_;
+        return true;
+    }
+
+    // these do not need to render the buffer again
+    void set_opacity(float opacity) { opacity_ = opacity; }
+    // offsets are whole pixels, so the buffer is never resampled
+    void set_offset(int offset_x, int offset_y) {
+        offset_x_ = offset_x;
+        offset_y_ = offset_y;
+    }
+    // render used to render the buffer
+    void set_render(render::RenderPtr render) {
+        valid_ = false;
+        render_ = std::move(render);
+    }
+
+    float opacity() const { return opacity_; }
+    int offset_x() const { return offset_x_; }
+    int offset_y() const { return offset_y_; }
+    const ShapeList &shapes() const { return shapes_; }
+
+private:
+    // render buffer if it's invalid
+    void Update() const {
+        if (valid_) return;
+        valid_ = true;
+        // union of draw areas
+        area_ = Rect(0, 0, -1, -1);
+        for (const auto &shape : shapes_) {
+            auto area = shape->GetDrawArea();
+            if (area.left > area.right || area.top > area.bottom) continue;
+            if (area_.left > area_.right) {
+                area_ = area;
+                continue;
+            }
+            area_.left = util::Min(area_.left, area.left);
+            area_.top = util::Min(area_.top, area.top);
+            area_.right = util::Max(area_.right, area.right);
+            area_.bottom = util::Max(area_.bottom, area.bottom);
+        }
+        if (area_.left > area_.right) return;
+        // move shapes to the origin of buffer
+        ShapeList shapes;
+        for (const auto &shape : shapes_) {
+            auto moved = std::make_shared<Operation>(Operation::Opcode::OffsetX,
+                    shape, -area_.left);
+            moved = std::make_shared<Operation>(Operation::Opcode::OffsetY,
+                    moved, -area_.top);
+            moved->set_color(shape->color());
+            shapes.push_back(moved);
+        }
+        // render on transparent background
+        int width = area_.right - area_.left + 1;
+        int height = area_.bottom - area_.top + 1;
+        buffer_.resize(width * height * 4);
+        render_->ReadBuffer(buffer_.data(), width, height,
+                color::PixelFormat::PremulRGBA8);
+        render_->Redraw(color::SolidColor(0, 0.F), shapes);
+    }
+
+    ShapeList shapes_;
+    float opacity_;
+    int offset_x_, offset_y_;
+    render::RenderPtr render_;
+    // cache of rendered shapes
+    mutable bool valid_;
+    mutable Rect area_;
+    mutable std::vector<color::Color8b> buffer_;
+};
+
+using LayerPtr = std::shared_ptr<Layer>;
+
+} // namespace cvf::shape
+
+#endif // CANVASFLAT_SHAPE_LAYER_H_
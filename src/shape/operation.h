@@ -5,25 +5,36 @@
 
 #include "shape.h"
 #include "../util/mathutil.h"
+#include "../util/fastmath.h"
 
 namespace cvf::shape {
 
 class Operation : public Shape {
 public:
+    // values are stored in scene files, new opcodes must be appended
     enum class Opcode : char {
         Union, Intersection, Difference,
         Rotate, Scale, Round, Blur, Outline,
-        OffsetX, OffsetY
+        OffsetX, OffsetY,
+        // boolean operations blended within distance 'param'
+        SmoothUnion, SmoothIntersection, SmoothDifference
     };
 
     Operation(Opcode opcode, ShapePtr opr1, ShapePtr opr2)
             : opcode_(opcode), opr1_(opr1), opr2_(opr2),
-              center_x_(0.F), center_y_(0.F), param_(0.F) {}
+              center_x_(0.F), center_y_(0.F), param_(0.F),
+              cos_(1.F), sin_(0.F) {}
+    Operation(Opcode opcode, ShapePtr opr1, ShapePtr opr2, float param)
+            : opcode_(opcode), opr1_(opr1), opr2_(opr2),
+              center_x_(0.F), center_y_(0.F), param_(param),
+              cos_(1.F), sin_(0.F) {}
     Operation(Opcode opcode, ShapePtr opr, float param)
             : opcode_(opcode), opr1_(opr), opr2_(nullptr), param_(param) {
         auto area = opr1_->GetDrawArea();
         center_x_ = area.left + (area.right - area.left) / 2;
         center_y_ = area.top + (area.bottom - area.top) / 2;
+        cos_ = std::cos(param_);
+        sin_ = std::sin(param_);
     }
 
     float GetSDF(float x, float y) const override {
@@ -37,6 +48,18 @@ public:
             case Opcode::Difference: {
                 return util::Max(opr1_->GetSDF(x, y), -opr2_->GetSDF(x, y));
             }
+            case Opcode::SmoothUnion: {
+                return util::SmoothMin(opr1_->GetSDF(x, y),
+                        opr2_->GetSDF(x, y), param_);
+            }
+            case Opcode::SmoothIntersection: {
+                return util::SmoothMax(opr1_->GetSDF(x, y),
+                        opr2_->GetSDF(x, y), param_);
+            }
+            case Opcode::SmoothDifference: {
+                return util::SmoothMax(opr1_->GetSDF(x, y),
+                        -opr2_->GetSDF(x, y), param_);
+            }
             case Opcode::Rotate: case Opcode::OffsetX: case Opcode::OffsetY: {
                 CoordMapping(x, y);
                 return opr1_->GetSDF(x, y);
@@ -53,107 +76,153 @@ public:
                 return util::LinearMapping(sdf, -0.5 * param_, 0.5, -0.5, 0.5);
             }
             case Opcode::Outline: {
-                auto outer = opr1_->GetSDF(x, y) - param_ / 2;
-                auto inner = opr1_->GetSDF(x, y) + param_ / 2;
-                return util::Max(outer, -inner);
+                auto sdf = opr1_->GetSDF(x, y);
+                return util::Max(sdf - param_ / 2, -(sdf + param_ / 2));
             }
         }
     }
 
-    Rect GetDrawArea() const override {
-        int x0, y0, x1, y1;
+    // coverage of boolean operations & translations are composed from
+    // operands approximately, others fall back to the SDF of pixel center
+    float GetCoverage(const RectF &pixel) const override {
         switch (opcode_) {
             case Opcode::Union: {
-                auto r1 = opr1_->GetDrawArea(), r2 = opr2_->GetDrawArea();
-                x0 = util::Min(r1.left, r2.left);
-                y0 = util::Min(r1.top, r2.top);
-                x1 = util::Max(r1.right, r2.right);
-                y1 = util::Max(r1.bottom, r2.bottom);
-                break;
+                return util::Max(opr1_->GetCoverage(pixel),
+                        opr2_->GetCoverage(pixel));
             }
             case Opcode::Intersection: {
-                auto r1 = opr1_->GetDrawArea(), r2 = opr2_->GetDrawArea();
-                x0 = util::Max(r1.left, r2.left);
-                y0 = util::Max(r1.top, r2.top);
-                x1 = util::Min(r1.right, r2.right);
-                y1 = util::Min(r1.bottom, r2.bottom);
-                break;
+                return util::Min(opr1_->GetCoverage(pixel),
+                        opr2_->GetCoverage(pixel));
+            }
+            case Opcode::Difference: {
+                return util::Min(opr1_->GetCoverage(pixel),
+                        1.F - opr2_->GetCoverage(pixel));
+            }
+            case Opcode::Scale: case Opcode::OffsetX: case Opcode::OffsetY: {
+                // non-positive scales do not map pixels to rectangles
+                if (opcode_ == Opcode::Scale && param_ <= 0.F) break;
+                RectF rect = pixel;
+                CoordMapping(rect.left, rect.top);
+                CoordMapping(rect.right, rect.bottom);
+                return opr1_->GetCoverage(rect);
+            }
+            default:;
+        }
+        return Shape::GetCoverage(pixel);
+    }
+
+    bool IsExact() const override {
+        switch (opcode_) {
+            // smooth ones are not exact distances, but never change
+            // faster than their operands
+            case Opcode::Union: case Opcode::Intersection:
+            case Opcode::Difference: case Opcode::SmoothUnion:
+            case Opcode::SmoothIntersection: case Opcode::SmoothDifference: {
+                return opr1_->IsExact() && opr2_->IsExact();
+            }
+            // distances are scaled by 'param', negative ones flip the sign
+            case Opcode::Scale: {
+                return param_ > 0.F && opr1_->IsExact();
+            }
+            // slope of blur mapping is 1 / (0.5 * param + 0.5)
+            case Opcode::Blur: {
+                return param_ >= 1.F && opr1_->IsExact();
+            }
+            default: return opr1_->IsExact();
+        }
+    }
+
+    int GetNodeCount() const override {
+        return 1 + opr1_->GetNodeCount()
+                + (opr2_ ? opr2_->GetNodeCount() : 0);
+    }
+
+    Bounds GetBounds() const override {
+        switch (opcode_) {
+            case Opcode::Union: {
+                return Bounds::Union(opr1_->GetBounds(),
+                        opr2_->GetBounds());
+            }
+            case Opcode::Intersection: {
+                return Bounds::Intersection(opr1_->GetBounds(),
+                        opr2_->GetBounds());
+            }
+            // the subtracted part can not be told from bounds,
+            // use 'ShrinkWrap' to tighten such shapes
+            case Opcode::Difference: case Opcode::SmoothDifference: {
+                return opr1_->GetBounds();
             }
-            case Opcode::Difference: case Opcode::Blur: {
-                return opr1_->GetDrawArea();
+            // blending fills the gaps between operands, which moves the
+            // boundary outward by at most 'param / 4' if both SDFs are
+            // distances, others may be blended anywhere within 'param'
+            case Opcode::SmoothUnion: {
+                auto grow = IsDistance(*opr1_) && IsDistance(*opr2_)
+                        ? param_ / 4 : param_;
+                return Bounds::Union(opr1_->GetBounds(),
+                        opr2_->GetBounds()).Grow(grow);
             }
+            // blending only removes the corners of intersection
+            case Opcode::SmoothIntersection: {
+                return Bounds::Intersection(opr1_->GetBounds(),
+                        opr2_->GetBounds());
+            }
+            // blur only spreads inward, visible pixels never exceed
+            // the ones of operand
+            case Opcode::Blur: {
+                return opr1_->GetBounds();
+            }
+            // rotate the box itself, so that rotations do not compound
+            // axis-aligned rectangles level by level
             case Opcode::Rotate: {
-                auto area = opr1_->GetDrawArea();
-                float tx0 = area.left, ty0 = area.top;
-                float tx1 = area.right, ty1 = area.top;
-                float tx2 = area.right, ty2 = area.bottom;
-                float tx3 = area.left, ty3 = area.bottom;
-                CoordMapping(tx0, ty0, true);
-                CoordMapping(tx1, ty1, true);
-                CoordMapping(tx2, ty2, true);
-                CoordMapping(tx3, ty3, true);
-                x0 = std::floorf(util::Min(tx0, tx1, tx2, tx3));
-                y0 = std::floorf(util::Min(ty0, ty1, ty2, ty3));
-                x1 = std::ceilf(util::Max(tx0, tx1, tx2, tx3));
-                y1 = std::ceilf(util::Max(ty0, ty1, ty2, ty3));
-                break;
+                return opr1_->GetBounds().Rotate(center_x_, center_y_,
+                        cos_, sin_);
             }
-            case Opcode::Scale: case Opcode::OffsetX: case Opcode::OffsetY: {
-                auto area = opr1_->GetDrawArea();
-                float tx0 = area.left, ty0 = area.top;
-                float tx1 = area.right, ty1 = area.bottom;
-                CoordMapping(tx0, ty0, true);
-                CoordMapping(tx1, ty1, true);
-                x0 = std::floorf(tx0);
-                y0 = std::floorf(ty0);
-                x1 = std::ceilf(tx1);
-                y1 = std::ceilf(ty1);
-                break;
+            case Opcode::Scale: {
+                return opr1_->GetBounds().Scale(center_x_, center_y_,
+                        param_);
+            }
+            case Opcode::OffsetX: {
+                return opr1_->GetBounds().Offset(param_, 0.F);
+            }
+            case Opcode::OffsetY: {
+                return opr1_->GetBounds().Offset(0.F, param_);
             }
             case Opcode::Round: {
-                auto area = opr1_->GetDrawArea();
-                float tx0 = area.left, ty0 = area.top;
-                float tx1 = area.right, ty1 = area.bottom;
-                tx0 -= param_;
-                ty0 -= param_;
-                tx1 += param_;
-                ty1 += param_;
-                x0 = std::floorf(tx0);
-                y0 = std::floorf(ty0);
-                x1 = std::ceilf(tx1);
-                y1 = std::ceilf(ty1);
-                break;
+                return opr1_->GetBounds().Grow(param_);
             }
             case Opcode::Outline: {
-                auto area = opr1_->GetDrawArea();
-                float tx0 = area.left, ty0 = area.top;
-                float tx1 = area.right, ty1 = area.bottom;
-                tx0 -= param_ / 2;
-                ty0 -= param_ / 2;
-                tx1 += param_ / 2;
-                ty1 += param_ / 2;
-                x0 = std::floorf(tx0);
-                y0 = std::floorf(ty0);
-                x1 = std::ceilf(tx1);
-                y1 = std::ceilf(ty1);
-                break;
+                return opr1_->GetBounds().Grow(param_ / 2);
             }
         }
-        return Rect(x0, y0, x1, y1);
+        return opr1_->GetBounds();
+    }
+
+    Rect GetDrawArea() const override { return GetBounds().GetRect(); }
+
+    // if operation takes two operands
+    static bool IsBinary(Opcode opcode) {
+        return opcode <= Opcode::Difference
+                || opcode >= Opcode::SmoothUnion;
     }
 
 private:
+    // exact SDF which keeps growing away from the shape, blur is exact
+    // but stops at 0.5 outside, so it tells nothing of the distance
+    static bool IsDistance(const Shape &shape) {
+        auto op = dynamic_cast<const Operation *>(&shape);
+        return shape.IsExact() && !(op && op->opcode_ == Opcode::Blur);
+    }
+
     // !reverse: processed -> orignal
     //  reverse: orignal   -> processed
     void CoordMapping(float &x, float &y, bool reverse = false) const {
         auto x1 = x - center_x_, y1 = y - center_y_;
         switch (opcode_) {
             case Opcode::Rotate: {
-                auto rho = std::sqrtf(x1 * x1 + y1 * y1);
-                float theta = std::atan2f(y1, x1);
-                theta += reverse ? param_ : -param_;
-                x = rho * std::cosf(theta) + center_x_;
-                y = rho * std::sinf(theta) + center_y_;
+                // sine & cosine of rotation are computed in constructor
+                auto s = reverse ? sin_ : -sin_;
+                x = x1 * cos_ - y1 * s + center_x_;
+                y = x1 * s + y1 * cos_ + center_y_;
                 break;
             }
             case Opcode::Scale: {
@@ -181,7 +250,7 @@ private:
 
     Opcode opcode_;
     ShapePtr opr1_, opr2_;
-    float center_x_, center_y_, param_;
+    float center_x_, center_y_, param_, cos_, sin_;
 };
 
 } // namespace cvf::shape
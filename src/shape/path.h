@@ -0,0 +1,446 @@
+#ifndef CANVASFLAT_SHAPE_PATH_H_
+#define CANVASFLAT_SHAPE_PATH_H_
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <atomic>
+#include <utility>
+
+#include "shape.h"
+#include "../util/mathutil.h"
+
+namespace cvf::shape {
+
+// closed outline made of lines & quadratic Bezier curves, filled by the
+// nonzero winding rule, contours are closed by lines to their starts
+// contours should not cross each other or themselves, since distances
+// are measured to edges, edges inside the filled area become seams
+//
+// segments are split where they turn vertically, so every edge is
+// monotonic in y & crosses a scanline at most once
+// 'GetSDF' finds the nearest edge in a uniform grid of edges, visiting
+// cells ring by ring until the rest can not be nearer, & the sign comes
+// from the winding of a ray along +x, which visits the edges of a band
+// 'GetSDFRow' walks the edges of the band like batches, pixels farther
+// than 'kCullMargin' from the outline get +/-'kCullMargin', & signs of
+// the whole row come from the sorted crossings of the scanline
+//
+// edges, grid & bands are rebuilt by the first evaluation after changes
+class Path : public Shape {
+public:
+    static constexpr float kCullMargin = 2.F;
+    static constexpr int kBandHeight = 16;
+
+    Path()
+            : start_x_(0), start_y_(0), last_x_(0), last_y_(0),
+              left_(std::numeric_limits<float>::max()),
+              top_(std::numeric_limits<float>::max()),
+              right_(std::numeric_limits<float>::lowest()),
+              bottom_(std::numeric_limits<float>::lowest()),
+              built_(false) {}
+
+    // start a new contour at (x, y), the current one is closed
+    void MoveTo(float x, float y) {
+        Close();
+        start_x_ = last_x_ = x;
+        start_y_ = last_y_ = y;
+    }
+
+    void LineTo(float x, float y) {
+        AddSegment({last_x_, last_y_, (last_x_ + x) / 2,
+                (last_y_ + y) / 2, x, y, true});
+    }
+
+    // curve with control point (cx, cy)
+    void QuadTo(float cx, float cy, float x, float y) {
+        AddSegment({last_x_, last_y_, cx, cy, x, y, false});
+    }
+
+    // close the current contour by a line to its start
+    void Close() {
+        if (last_x_ != start_x_ || last_y_ != start_y_) {
+            LineTo(start_x_, start_y_);
+        }
+    }
+
+    float GetSDF(float x, float y) const override {
+        Build();
+        if (edges_.empty()) return std::numeric_limits<float>::max();
+        auto sdf = GetDistance(x, y);
+        return GetWinding(x, y) ? -sdf : sdf;
+    }
+
+    void GetSDFRow(float x, float y, int count, float *sdf) const override {
+        Build();
+        for (int i = 0; i < count; ++i) sdf[i] = kCullMargin;
+        // crossings of scanline sorted by x, signs are evaluated pixel
+        // by pixel if there are too many of them
+        constexpr int kMaxCrossings = 64;
+        float cross_x[kMaxCrossings];
+        int cross_dir[kMaxCrossings], crossings = 0, winding = 0;
+        bool overflow = false;
+        for (auto i : GetBandEdges(y)) {
+            const auto &edge = edges_[i];
+            float cx;
+            if (GetCrossing(edge, y, cx)) {
+                if (crossings < kMaxCrossings) {
+                    int j = crossings++;
+                    for (; j && cross_x[j - 1] > cx; --j) {
+                        cross_x[j] = cross_x[j - 1];
+                        cross_dir[j] = cross_dir[j - 1];
+                    }
+                    cross_x[j] = cx;
+                    cross_dir[j] = edge.dir;
+                }
+                else {
+                    overflow = true;
+                }
+                winding += edge.dir;
+            }
+            // distances of pixels within the margin
+            if (y <= edge.top - kCullMargin
+                    || y >= edge.bottom + kCullMargin) {
+                continue;
+            }
+            int first = util::Max(static_cast<int>(
+                    std::ceilf(edge.left - kCullMargin - x)), 0);
+            int last = util::Min(static_cast<int>(
+                    std::floorf(edge.right + kCullMargin - x)), count - 1);
+            for (int j = first; j <= last; ++j) {
+                auto d = GetEdgeDistance(edge, x + j, y);
+                sdf[j] = d < sdf[j] ? d : sdf[j];
+            }
+        }
+        if (overflow) {
+            for (int i = 0; i < count; ++i) {
+                if (GetWinding(x + i, y)) sdf[i] = -sdf[i];
+            }
+            return;
+        }
+        // 'winding' counts crossings on the right of current pixel
+        for (int i = 0, k = 0; i < count; ++i) {
+            for (; k < crossings && cross_x[k] <= x + i; ++k) {
+                winding -= cross_dir[k];
+            }
+            if (winding) sdf[i] = -sdf[i];
+        }
+    }
+
+    bool IsExact() const override { return true; }
+
+    // box of all points, including control points
+    Bounds GetBounds() const override {
+        if (empty()) return Bounds();
+        return Bounds(RectF(left_, top_, right_, bottom_));
+    }
+
+    Rect GetDrawArea() const override {
+        if (empty()) return Rect(0, 0, -1, -1);
+        return Rect(std::floorf(left_), std::floorf(top_),
+                std::ceilf(right_), std::ceilf(bottom_));
+    }
+
+    bool empty() const { return left_ > right_; }
+    // count of segments, including lines closing contours
+    int size() const { return segments_.size(); }
+
+private:
+    // line or quadratic curve from (x0, y0) to (x2, y2), lines keep
+    // their midpoints as control points
+    struct Segment {
+        float x0, y0, x1, y1, x2, y2;
+        bool line;
+    };
+
+    // segment monotonic in y, with the box of its points
+    struct Edge {
+        Segment seg;
+        float left, top, right, bottom;
+        // +1 if going down, -1 if going up, 0 if horizontal
+        int dir;
+    };
+
+    void AddSegment(const Segment &seg) {
+        segments_.push_back(seg);
+        left_ = util::Min(left_, seg.x0, seg.x1, seg.x2);
+        top_ = util::Min(top_, seg.y0, seg.y1, seg.y2);
+        right_ = util::Max(right_, seg.x0, seg.x1, seg.x2);
+        bottom_ = util::Max(bottom_, seg.y0, seg.y1, seg.y2);
+        last_x_ = seg.x2;
+        last_y_ = seg.y2;
+        built_.store(false, std::memory_order_release);
+    }
+
+    // build edges, grid & bands if the path is changed
+    void Build() const {
+        if (built_.load(std::memory_order_acquire)) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (built_.load(std::memory_order_relaxed)) return;
+        edges_.clear();
+        for (const auto &seg : segments_) AddEdges(seg);
+        // the current contour may be open
+        if (last_x_ != start_x_ || last_y_ != start_y_) {
+            AddEdges({last_x_, last_y_, (last_x_ + start_x_) / 2,
+                    (last_y_ + start_y_) / 2, start_x_, start_y_, true});
+        }
+        BuildGrid();
+        BuildBands();
+        built_.store(true, std::memory_order_release);
+    }
+
+    // split segment into edges monotonic in y
+    void AddEdges(const Segment &seg) const {
+        auto ay = seg.y0 - 2 * seg.y1 + seg.y2;
+        auto t = ay ? (seg.y0 - seg.y1) / ay : 0.F;
+        if (seg.line || t <= 0.F || t >= 1.F) {
+            AddEdge(seg);
+            return;
+        }
+        // de Casteljau
+        auto x01 = seg.x0 + (seg.x1 - seg.x0) * t;
+        auto y01 = seg.y0 + (seg.y1 - seg.y0) * t;
+        auto x12 = seg.x1 + (seg.x2 - seg.x1) * t;
+        auto y12 = seg.y1 + (seg.y2 - seg.y1) * t;
+        auto xm = x01 + (x12 - x01) * t, ym = y01 + (y12 - y01) * t;
+        AddEdge({seg.x0, seg.y0, x01, ym, xm, ym, false});
+        AddEdge({xm, ym, x12, ym, seg.x2, seg.y2, false});
+    }
+
+    void AddEdge(Segment seg) const {
+        // curves deviate from their chords by |b| / 4 at most, those
+        // close to lines are lines, on which the closed form fails
+        auto bx = seg.x0 - 2 * seg.x1 + seg.x2;
+        auto by = seg.y0 - 2 * seg.y1 + seg.y2;
+        if (bx * bx + by * by < 1e-5F) seg.line = true;
+        Edge edge;
+        edge.seg = seg;
+        edge.left = util::Min(seg.x0, seg.x1, seg.x2);
+        edge.top = util::Min(seg.y0, seg.y1, seg.y2);
+        edge.right = util::Max(seg.x0, seg.x1, seg.x2);
+        edge.bottom = util::Max(seg.y0, seg.y1, seg.y2);
+        edge.dir = seg.y2 > seg.y0 ? 1 : seg.y2 < seg.y0 ? -1 : 0;
+        edges_.push_back(edge);
+    }
+
+    // put edges into cells they pass through, about one cell per edge
+    void BuildGrid() const {
+        cell_start_.clear();
+        cell_edges_.clear();
+        if (edges_.empty()) return;
+        auto width = right_ - left_, height = bottom_ - top_;
+        cell_size_ = std::sqrtf(util::Max(width * height, 1.F)
+                / edges_.size());
+        cell_size_ = util::Max(cell_size_, 1.F,
+                util::Max(width, height) / 1024);
+        cols_ = util::Max(static_cast<int>(
+                std::ceilf(width / cell_size_)), 1);
+        rows_ = util::Max(static_cast<int>(
+                std::ceilf(height / cell_size_)), 1);
+        // an edge is put into a cell if it touches the circumcircle
+        std::vector<std::pair<int, int>> pairs;
+        auto radius = cell_size_ * 0.7072F;
+        for (int i = 0; i < static_cast<int>(edges_.size()); ++i) {
+            const auto &edge = edges_[i];
+            int x0 = GetCellX(edge.left), x1 = GetCellX(edge.right);
+            int y0 = GetCellY(edge.top), y1 = GetCellY(edge.bottom);
+            for (int y = y0; y <= y1; ++y) {
+                for (int x = x0; x <= x1; ++x) {
+                    auto cx = left_ + (x + 0.5F) * cell_size_;
+                    auto cy = top_ + (y + 0.5F) * cell_size_;
+                    if (GetEdgeDistance(edge, cx, cy) <= radius) {
+                        pairs.push_back({y * cols_ + x, i});
+                    }
+                }
+            }
+        }
+        // counting sort by cells
+        cell_start_.assign(cols_ * rows_ + 1, 0);
+        for (const auto &i : pairs) ++cell_start_[i.first + 1];
+        for (int i = 0; i < cols_ * rows_; ++i) {
+            cell_start_[i + 1] += cell_start_[i];
+        }
+        cell_edges_.resize(pairs.size());
+        auto pos = cell_start_;
+        for (const auto &i : pairs) cell_edges_[pos[i.first]++] = i.second;
+    }
+
+    // put edges into bands of rows they may affect within the margin
+    void BuildBands() const {
+        bands_.clear();
+        band_origin_ = 0;
+        if (edges_.empty()) return;
+        band_origin_ = std::floorf((top_ - kCullMargin) / kBandHeight);
+        int last = std::floorf((bottom_ + kCullMargin) / kBandHeight);
+        bands_.resize(last - band_origin_ + 1);
+        for (int i = 0; i < static_cast<int>(edges_.size()); ++i) {
+            const auto &edge = edges_[i];
+            int y0 = std::floorf((edge.top - kCullMargin) / kBandHeight);
+            int y1 = std::floorf((edge.bottom + kCullMargin) / kBandHeight);
+            for (int j = y0; j <= y1; ++j) {
+                bands_[j - band_origin_].push_back(i);
+            }
+        }
+    }
+
+    int GetCellX(float x) const {
+        int cell = std::floorf((x - left_) / cell_size_);
+        return util::Min(util::Max(cell, 0), cols_ - 1);
+    }
+
+    int GetCellY(float y) const {
+        int cell = std::floorf((y - top_) / cell_size_);
+        return util::Min(util::Max(cell, 0), rows_ - 1);
+    }
+
+    // get indices of edges which may cross or affect row 'y'
+    const std::vector<int> &GetBandEdges(float y) const {
+        static const std::vector<int> empty_band;
+        int band = std::floorf(y / kBandHeight);
+        band -= band_origin_;
+        if (band < 0 || band >= static_cast<int>(bands_.size())) {
+            return empty_band;
+        }
+        return bands_[band];
+    }
+
+    // distance to the nearest edge, a cell in ring r around the cell of
+    // point is at least (r - 1) cells away from it, even if the point
+    // is out of grid
+    float GetDistance(float x, float y) const {
+        auto dist = std::numeric_limits<float>::max();
+        int cx = GetCellX(x), cy = GetCellY(y);
+        int rings = util::Max(cx, cols_ - 1 - cx, cy, rows_ - 1 - cy);
+        for (int r = 0; r <= rings && (r - 1) * cell_size_ < dist; ++r) {
+            int y0 = util::Max(cy - r, 0), y1 = util::Min(cy + r, rows_ - 1);
+            for (int j = y0; j <= y1; ++j) {
+                // cells of middle rows are on the left & right sides
+                int step = j == cy - r || j == cy + r ? 1 : 2 * r;
+                for (int i = cx - r; i <= cx + r; i += step) {
+                    if (i < 0 || i >= cols_) continue;
+                    int cell = j * cols_ + i;
+                    for (int k = cell_start_[cell];
+                            k < cell_start_[cell + 1]; ++k) {
+                        auto d = GetEdgeDistance(edges_[cell_edges_[k]],
+                                x, y);
+                        dist = d < dist ? d : dist;
+                    }
+                }
+            }
+        }
+        return dist;
+    }
+
+    // winding number of point, by crossings of the ray along +x
+    int GetWinding(float x, float y) const {
+        int winding = 0;
+        for (auto i : GetBandEdges(y)) {
+            float cx;
+            if (GetCrossing(edges_[i], y, cx) && cx > x) {
+                winding += edges_[i].dir;
+            }
+        }
+        return winding;
+    }
+
+    // x of the crossing of edge & scanline y, false if not crossed,
+    // the range of y is half open, so shared endpoints count once
+    static bool GetCrossing(const Edge &edge, float y, float &x) {
+        const auto &s = edge.seg;
+        if ((s.y0 <= y) == (s.y2 <= y)) return false;
+        float t;
+        if (s.line) {
+            t = (y - s.y0) / (s.y2 - s.y0);
+            x = s.x0 + (s.x2 - s.x0) * t;
+            return true;
+        }
+        // solve a * t^2 + b * t + c = 0, only one root is in [0, 1]
+        auto a = s.y0 - 2 * s.y1 + s.y2, b = 2 * (s.y1 - s.y0);
+        auto c = s.y0 - y;
+        if (std::fabsf(a) <= 1e-4F * std::fabsf(b)) {
+            t = -c / b;
+        }
+        else {
+            auto d = std::sqrtf(util::Max(b * b - 4 * a * c, 0.F));
+            auto t0 = (-b - d) / (2 * a), t1 = (-b + d) / (2 * a);
+            t = std::fabsf(t0 - 0.5F) < std::fabsf(t1 - 0.5F) ? t0 : t1;
+        }
+        t = util::Min(util::Max(t, 0.F), 1.F);
+        auto u = 1 - t;
+        x = u * u * s.x0 + 2 * u * t * s.x1 + t * t * s.x2;
+        return true;
+    }
+
+    static float GetEdgeDistance(const Edge &edge, float x, float y) {
+        const auto &s = edge.seg;
+        if (s.line) {
+            auto dx0 = x - s.x0, dy0 = y - s.y0;
+            auto dx1 = s.x2 - s.x0, dy1 = s.y2 - s.y0;
+            auto len = dx1 * dx1 + dy1 * dy1;
+            auto h = len > 0.F ? (dx0 * dx1 + dy0 * dy1) / len : 0.F;
+            h = util::Min(util::Max(h, 0.F), 1.F);
+            auto dx = dx0 - dx1 * h, dy = dy0 - dy1 * h;
+            return std::sqrtf(dx * dx + dy * dy);
+        }
+        // nearest points are roots of a cubic, solved in closed form
+        auto ax = s.x1 - s.x0, ay = s.y1 - s.y0;
+        auto bx = s.x0 - 2 * s.x1 + s.x2, by = s.y0 - 2 * s.y1 + s.y2;
+        auto cx = ax * 2, cy = ay * 2;
+        auto dx = s.x0 - x, dy = s.y0 - y;
+        auto kk = 1 / (bx * bx + by * by);
+        auto kx = kk * (ax * bx + ay * by);
+        auto ky = kk * (2 * (ax * ax + ay * ay) + (dx * bx + dy * by)) / 3;
+        auto kz = kk * (dx * ax + dy * ay);
+        auto p = ky - kx * kx, q = kx * (2 * kx * kx - 3 * ky) + kz;
+        auto h = q * q + 4 * p * p * p;
+        // roots lose precision in float, so each one takes a Newton
+        // step, any t in [0, 1] is on the curve & never underestimates
+        auto dist2 = [&](float t) {
+            t = util::Min(util::Max(t, 0.F), 1.F);
+            auto ex = dx + (cx + bx * t) * t, ey = dy + (cy + by * t) * t;
+            auto tx = cx + 2 * bx * t, ty = cy + 2 * by * t;
+            auto g = ex * tx + ey * ty;
+            auto dg = tx * tx + ty * ty + 2 * (ex * bx + ey * by);
+            if (dg > 0.F) t = util::Min(util::Max(t - g / dg, 0.F), 1.F);
+            ex = dx + (cx + bx * t) * t;
+            ey = dy + (cy + by * t) * t;
+            return ex * ex + ey * ey;
+        };
+        float res;
+        if (h >= 0.F) {
+            h = std::sqrtf(h);
+            auto u = std::cbrt((h - q) / 2), v = std::cbrt((-h - q) / 2);
+            res = dist2(u + v - kx);
+        }
+        else {
+            auto z = std::sqrtf(-p);
+            auto w = std::acos(util::Min(util::Max(q / (p * z * 2), -1.F),
+                    1.F)) / 3;
+            auto m = std::cos(w), n = std::sin(w) * 1.732050808F;
+            res = util::Min(dist2((m + m) * z - kx),
+                    dist2((-n - m) * z - kx));
+        }
+        // endpoints, which are lost in precision near degenerate curves
+        res = util::Min(res, dx * dx + dy * dy);
+        auto ex = s.x2 - x, ey = s.y2 - y;
+        return std::sqrtf(util::Min(res, ex * ex + ey * ey));
+    }
+
+    std::vector<Segment> segments_;
+    float start_x_, start_y_, last_x_, last_y_;
+    float left_, top_, right_, bottom_;
+    // built by the first evaluation after changes
+    mutable std::mutex mutex_;
+    mutable std::atomic<bool> built_;
+    mutable std::vector<Edge> edges_;
+    mutable float cell_size_;
+    mutable int cols_, rows_;
+    mutable std::vector<int> cell_start_, cell_edges_;
+    mutable int band_origin_;
+    mutable std::vector<std::vector<int>> bands_;
+};
+
+} // namespace cvf::shape
+
+#endif // CANVASFLAT_SHAPE_PATH_H_
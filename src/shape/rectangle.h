@@ -4,6 +4,8 @@
 #include <cmath>
 
 #include "shape.h"
+#include "../util/mathutil.h"
+#include "../util/fastmath.h"
 
 namespace cvf::shape {
 
@@ -19,10 +21,39 @@ public:
     }
 
     float GetSDF(float x, float y) const override {
-        auto dx = std::fabsf(x - cx_) - sx_, ax = std::fmaxf(dx, 0.F);
-        auto dy = std::fabsf(y - cy_) - sy_, ay = std::fmaxf(dy, 0.F);
-        return std::fminf(std::fmaxf(dx, dy), 0.F)
-                + std::sqrtf(ax * ax + ay * ay);
+        return util::WithMath([&](auto math) { return GetSDF(math, x, y); });
+    }
+
+    void GetSDFRow(float x, float y, int count, float *sdf) const override {
+        util::WithMath([&](auto math) {
+            for (int i = 0; i < count; ++i) sdf[i] = GetSDF(math, x + i, y);
+        });
+    }
+
+    // SDF using math functions of 'Math'
+    template <typename Math>
+    float GetSDF(Math, float x, float y) const {
+        // plain comparisons, 'fminf' & 'fmaxf' may not be inlined
+        auto dx = std::fabsf(x - cx_) - sx_, ax = dx > 0.F ? dx : 0.F;
+        auto dy = std::fabsf(y - cy_) - sy_, ay = dy > 0.F ? dy : 0.F;
+        auto d = dx > dy ? dx : dy;
+        return (d < 0.F ? d : 0.F) + Math::Sqrt(ax * ax + ay * ay);
+    }
+
+    // exact area of intersection of the rectangle and pixel
+    float GetCoverage(const RectF &pixel) const override {
+        auto w = util::Min(pixel.right, cx_ + sx_)
+                - util::Max(pixel.left, cx_ - sx_);
+        auto h = util::Min(pixel.bottom, cy_ + sy_)
+                - util::Max(pixel.top, cy_ - sy_);
+        if (w <= 0.F || h <= 0.F) return 0.F;
+        return w * h / (pixel.width() * pixel.height());
+    }
+
+    bool IsExact() const override { return true; }
+
+    Bounds GetBounds() const override {
+        return Bounds(cx_, cy_, sx_, sy_);
     }
 
     Rect GetDrawArea() const override {
@@ -36,7 +67,7 @@ public:
 private:
     void InitParam() {
         sx_ = width_ / 2;
-        sy_ = width_ / 2;
+        sy_ = height_ / 2;
         cx_ = x0_ + sx_;
         cy_ = y0_ + sy_;
     }
@@ -3,8 +3,10 @@
 
 #include <memory>
 #include <vector>
+#include <cmath>
 
 #include "../color/color.h"
+#include "../util/mathutil.h"
 
 namespace cvf::shape {
 
@@ -15,6 +17,166 @@ struct Rect {
     int left, top, right, bottom;
 };
 
+struct RectF {
+    RectF() : left(0.F), top(0.F), right(0.F), bottom(0.F) {}
+    RectF(float left, float top, float right, float bottom)
+            : left(left), top(top), right(right), bottom(bottom) {}
+
+    float width() const { return right - left; }
+    float height() const { return bottom - top; }
+    float center_x() const { return (left + right) / 2; }
+    float center_y() const { return (top + bottom) / 2; }
+
+    float left, top, right, bottom;
+};
+
+// oriented bounding box, a rectangle of half extents
+// (half_width, half_height) around its center, rotated by an angle
+// whose cosine & sine are stored, empty if any half extent is negative
+struct Bounds {
+    Bounds() : Bounds(0.F, 0.F, -1.F, -1.F) {}
+    Bounds(float center_x, float center_y,
+            float half_width, float half_height)
+            : Bounds(center_x, center_y, half_width, half_height,
+                     1.F, 0.F) {}
+    Bounds(float center_x, float center_y,
+            float half_width, float half_height, float cos, float sin)
+            : center_x(center_x), center_y(center_y),
+              half_width(half_width), half_height(half_height),
+              cos(cos), sin(sin) {}
+    Bounds(const RectF &rect)
+            : Bounds(rect.center_x(), rect.center_y(),
+                     rect.width() / 2, rect.height() / 2) {}
+    Bounds(const Rect &rect)
+            : Bounds(RectF(rect.left, rect.top, rect.right, rect.bottom)) {}
+
+    bool empty() const { return half_width < 0.F || half_height < 0.F; }
+    float area() const {
+        return empty() ? 0.F : 4 * half_width * half_height;
+    }
+
+    // axis-aligned bounding rectangle
+    RectF GetRectF() const {
+        auto ac = std::fabs(cos), as = std::fabs(sin);
+        auto ex = ac * half_width + as * half_height;
+        auto ey = as * half_width + ac * half_height;
+        return RectF(center_x - ex, center_y - ey,
+                center_x + ex, center_y + ey);
+    }
+
+    // the smallest pixel area containing the bounds
+    Rect GetRect() const {
+        if (empty()) return Rect(0, 0, -1, -1);
+        auto rect = GetRectF();
+        return Rect(std::floor(rect.left), std::floor(rect.top),
+                std::ceil(rect.right), std::ceil(rect.bottom));
+    }
+
+    // rotate around pivot (px, py), by the angle of (c, s)
+    Bounds Rotate(float px, float py, float c, float s) const {
+        auto dx = center_x - px, dy = center_y - py;
+        return Bounds(dx * c - dy * s + px, dx * s + dy * c + py,
+                half_width, half_height,
+                cos * c - sin * s, sin * c + cos * s);
+    }
+
+    // scale around pivot (px, py)
+    Bounds Scale(float px, float py, float k) const {
+        auto ak = std::fabs(k);
+        return Bounds((center_x - px) * k + px, (center_y - py) * k + py,
+                half_width * ak, half_height * ak, cos, sin);
+    }
+
+    Bounds Offset(float dx, float dy) const {
+        return Bounds(center_x + dx, center_y + dy,
+                half_width, half_height, cos, sin);
+    }
+
+    // grow by 'd' in all directions
+    Bounds Grow(float d) const {
+        if (empty()) return *this;
+        return Bounds(center_x, center_y, half_width + d, half_height + d,
+                cos, sin);
+    }
+
+    // bounds of both, boxes of the same orientation are merged in their
+    // own frame, others are merged as axis-aligned rectangles
+    static Bounds Union(const Bounds &a, const Bounds &b) {
+        if (a.empty()) return b;
+        if (b.empty()) return a;
+        if (IsParallel(a, b)) {
+            auto la = a.GetLocalRect(a), lb = a.GetLocalRect(b);
+            return a.FromLocalRect(RectF(std::fmin(la.left, lb.left),
+                    std::fmin(la.top, lb.top),
+                    std::fmax(la.right, lb.right),
+                    std::fmax(la.bottom, lb.bottom)));
+        }
+        auto ra = a.GetRectF(), rb = b.GetRectF();
+        return Bounds(RectF(std::fmin(ra.left, rb.left),
+                std::fmin(ra.top, rb.top), std::fmax(ra.right, rb.right),
+                std::fmax(ra.bottom, rb.bottom)));
+    }
+
+    // bounds of the common part, boxes of different orientations give
+    // the smallest one of themselves & the overlap of their rectangles
+    static Bounds Intersection(const Bounds &a, const Bounds &b) {
+        if (a.empty()) return a;
+        if (b.empty()) return b;
+        if (IsParallel(a, b)) {
+            auto la = a.GetLocalRect(a), lb = a.GetLocalRect(b);
+            return a.FromLocalRect(RectF(std::fmax(la.left, lb.left),
+                    std::fmax(la.top, lb.top),
+                    std::fmin(la.right, lb.right),
+                    std::fmin(la.bottom, lb.bottom)));
+        }
+        auto ra = a.GetRectF(), rb = b.GetRectF();
+        Bounds rect(RectF(std::fmax(ra.left, rb.left),
+                std::fmax(ra.top, rb.top), std::fmin(ra.right, rb.right),
+                std::fmin(ra.bottom, rb.bottom)));
+        if (rect.empty()) return rect;
+        const Bounds *best = &rect;
+        if (a.area() < best->area()) best = &a;
+        if (b.area() < best->area()) best = &b;
+        return *best;
+    }
+
+    float center_x, center_y, half_width, half_height, cos, sin;
+
+private:
+    static bool IsParallel(const Bounds &a, const Bounds &b) {
+        // also true if rotated by multiples of 90 degrees
+        auto cross = a.cos * b.sin - a.sin * b.cos;
+        auto dot = a.cos * b.cos + a.sin * b.sin;
+        return std::fabs(cross) < 1e-5F || std::fabs(dot) < 1e-5F;
+    }
+
+    // rectangle of a parallel box in the frame of this box
+    RectF GetLocalRect(const Bounds &b) const {
+        auto dx = b.center_x - center_x, dy = b.center_y - center_y;
+        auto x = dx * cos + dy * sin, y = -dx * sin + dy * cos;
+        auto dot = cos * b.cos + sin * b.sin;
+        auto hw = std::fabs(dot) > 0.5F ? b.half_width : b.half_height;
+        auto hh = std::fabs(dot) > 0.5F ? b.half_height : b.half_width;
+        return RectF(x - hw, y - hh, x + hw, y + hh);
+    }
+
+    Bounds FromLocalRect(const RectF &rect) const {
+        auto x = rect.center_x(), y = rect.center_y();
+        return Bounds(center_x + x * cos - y * sin,
+                center_y + x * sin + y * cos,
+                rect.width() / 2, rect.height() / 2, cos, sin);
+    }
+};
+
+// pixels of a pre-rendered shape in 'PremulRGBA8' format, stored row by
+// row for 'area' of canvas, which are composited instead of evaluating
+// SDF, see 'Layer'
+struct Raster {
+    const unsigned char *pixels;
+    Rect area;
+    float opacity;
+};
+
 class Shape {
 public:
     virtual ~Shape() = default;
@@ -22,6 +184,36 @@ public:
     virtual float GetSDF(float x, float y) const = 0;
     virtual Rect GetDrawArea() const = 0;
 
+    // conservative bounds of the shape (where SDF <= 0), primitives
+    // report exact boxes, operations propagate the boxes of operands
+    virtual Bounds GetBounds() const { return Bounds(GetDrawArea()); }
+
+    // get SDF of 'count' pixels from (x, y) to (x + count - 1, y),
+    // shapes which have a faster batched kernel can override this
+    virtual void GetSDFRow(float x, float y, int count, float *sdf) const {
+        for (int i = 0; i < count; ++i) sdf[i] = GetSDF(x + i, y);
+    }
+
+    // get the fraction of 'pixel' area covered by shape, primitives
+    // override this with closed forms, by default the SDF at the center
+    // of pixel is mapped linearly, which equals to anti-aliasing
+    virtual float GetCoverage(const RectF &pixel) const {
+        auto sdf = GetSDF(pixel.center_x(), pixel.center_y());
+        auto half = (pixel.width() + pixel.height()) / 4;
+        return util::LinearMapping(sdf, -half, half, 1, 0);
+    }
+
+    // true if SDF never overestimates the distance to the boundary
+    // (1-Lipschitz), so that a pixel with SDF d guarantees the pixels
+    // closer than |d| are on the same side, used to skip pixels
+    virtual bool IsExact() const { return false; }
+
+    // count of nodes evaluated by a call of 'GetSDF', for profiling
+    virtual int GetNodeCount() const { return 1; }
+
+    // get the pre-rendered pixels, false if shape is drawn by its SDF
+    virtual bool GetRaster(Raster &) const { return false; }
+
     void set_color(const color::Color &color) { color_ = color; }
     const color::Color &color() const { return color_; }
 
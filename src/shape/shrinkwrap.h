@@ -0,0 +1,87 @@
+#ifndef CANVASFLAT_SHAPE_SHRINKWRAP_H_
+#define CANVASFLAT_SHAPE_SHRINKWRAP_H_
+
+#include <vector>
+
+#include "shape.h"
+#include "../util/mathutil.h"
+
+namespace cvf::shape {
+
+// shape whose draw area is shrunk to the pixels it can actually touch,
+// found by sampling the SDF of another shape once in constructor
+// useful for shapes whose bounds can not be told from their operands
+// (e.g. 'Difference') and which are drawn many times
+class ShrinkWrappedShape : public Shape {
+public:
+    // pixels whose SDF is below the threshold are kept, which covers
+    // both anti-aliasing (0.5) and exact coverage (half diagonal)
+    static constexpr float kThreshold = 0.75F;
+
+    ShrinkWrappedShape(ShapePtr shape) : shape_(shape) {
+        color_ = shape_->color();
+        Shrink();
+    }
+
+    float GetSDF(float x, float y) const override {
+        return shape_->GetSDF(x, y);
+    }
+
+    void GetSDFRow(float x, float y, int count, float *sdf) const override {
+        shape_->GetSDFRow(x, y, count, sdf);
+    }
+
+    float GetCoverage(const RectF &pixel) const override {
+        return shape_->GetCoverage(pixel);
+    }
+
+    Rect GetDrawArea() const override { return area_; }
+    Bounds GetBounds() const override { return bounds_; }
+    bool IsExact() const override { return shape_->IsExact(); }
+    int GetNodeCount() const override { return shape_->GetNodeCount(); }
+
+    const ShapePtr &shape() const { return shape_; }
+
+private:
+    void Shrink() {
+        auto area = shape_->GetDrawArea();
+        int left = area.right + 1, right = area.left - 1;
+        int top = area.bottom + 1, bottom = area.top - 1;
+        int count = area.right - area.left + 1;
+        std::vector<float> sdf(util::Max(count, 0));
+        for (int y = area.top; y <= area.bottom && count > 0; ++y) {
+            shape_->GetSDFRow(area.left, y, count, sdf.data());
+            int first = count, last = -1;
+            for (int i = 0; i < count; ++i) {
+                if (sdf[i] < kThreshold) {
+                    first = util::Min(first, i);
+                    last = i;
+                }
+            }
+            if (last < 0) continue;
+            left = util::Min(left, area.left + first);
+            right = util::Max(right, area.left + last);
+            top = util::Min(top, y);
+            bottom = util::Max(bottom, y);
+        }
+        if (left > right) {
+            area_ = Rect(0, 0, -1, -1);
+            bounds_ = Bounds();
+        }
+        else {
+            area_ = Rect(left, top, right, bottom);
+            // points of shape lie within half a pixel of some kept pixel
+            // center, and the oriented bounds of operand may be tighter
+            bounds_ = Bounds::Intersection(shape_->GetBounds(),
+                    Bounds(area_).Grow(0.5F));
+        }
+    }
+
+    ShapePtr shape_;
+    Rect area_;
+    Bounds bounds_;
+};
+
+} // namespace cvf::shape
+
+#endif // CANVASFLAT_SHAPE_SHRINKWRAP_H_
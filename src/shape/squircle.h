@@ -4,22 +4,50 @@
 #include <cmath>
 
 #include "shape.h"
+#include "../util/fastmath.h"
+#include "../util/mathutil.h"
 
 namespace cvf::shape {
 
 class Squircle : public Shape {
 public:
+    // orders out of range are clamped to [1, kMaxOrder]
+    static constexpr int kMaxOrder = 16;
+
     Squircle(float center_x, float center_y, float r)
-            : center_x_(center_x), center_y_(center_y),
-              r_(r), order_(4.F) {}
+            : Squircle(center_x, center_y, r, 2) {}
     Squircle(float center_x, float center_y, float r, int order)
-            : center_x_(center_x), center_y_(center_y),
-              r_(r), order_(order * 2.F) {}
+            : center_x_(center_x), center_y_(center_y), r_(r) {
+        order = util::Max(util::Min(order, kMaxOrder), 1);
+        order_ = order * 2.F;
+        exponent_ = order * 2;
+    }
 
     float GetSDF(float x, float y) const override {
+        return util::WithMath([&](auto math) { return GetSDF(math, x, y); });
+    }
+
+    void GetSDFRow(float x, float y, int count, float *sdf) const override {
+        util::WithMath([&](auto math) {
+            for (int i = 0; i < count; ++i) sdf[i] = GetSDF(math, x + i, y);
+        });
+    }
+
+    // SDF using math functions of 'Math'
+    template <typename Math>
+    float GetSDF(Math, float x, float y) const {
         auto dx = x - center_x_, dy = y - center_y_;
-        auto pow_v = std::powf(dx, order_) + std::powf(dy, order_);
-        return std::powf(pow_v, 1.F / order_) - r_;
+        // exponent is always an even integer, so 'pow' is replaced
+        // by repeated multiplies, only the final root needs it
+        auto pow_v = util::IntPow(dx, exponent_) + util::IntPow(dy, exponent_);
+        return Math::Pow(pow_v, 1.F / order_) - r_;
+    }
+
+    // p-norms with p >= 2 never exceed the euclidean norm
+    bool IsExact() const override { return exponent_ >= 2; }
+
+    Bounds GetBounds() const override {
+        return Bounds(center_x_, center_y_, r_, r_);
     }
 
     Rect GetDrawArea() const override {
@@ -32,6 +60,7 @@ public:
 
 private:
     float center_x_, center_y_, r_, order_;
+    int exponent_;
 };
 
 } // namespace cvf::shape
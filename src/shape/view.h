@@ -0,0 +1,63 @@
+#ifndef CANVASFLAT_SHAPE_VIEW_H_
+#define CANVASFLAT_SHAPE_VIEW_H_
+
+#include "shape.h"
+
+namespace cvf::shape {
+
+// shape seen through a view whose origin is at (x0, y0) of the canvas
+// & which is magnified by 'scale', used to render regions of canvas
+class ViewShape : public Shape {
+public:
+    ViewShape(ShapePtr shape, float x0, float y0, float scale)
+            : shape_(shape), x0_(x0), y0_(y0), scale_(scale) {
+        color_ = shape_->color();
+    }
+
+    float GetSDF(float x, float y) const override {
+        return shape_->GetSDF(x0_ + x / scale_, y0_ + y / scale_) * scale_;
+    }
+
+    void GetSDFRow(float x, float y, int count, float *sdf) const override {
+        if (scale_ == 1.F) {
+            shape_->GetSDFRow(x0_ + x, y0_ + y, count, sdf);
+        }
+        else {
+            Shape::GetSDFRow(x, y, count, sdf);
+        }
+    }
+
+    float GetCoverage(const RectF &pixel) const override {
+        return shape_->GetCoverage(RectF(x0_ + pixel.left / scale_,
+                y0_ + pixel.top / scale_, x0_ + pixel.right / scale_,
+                y0_ + pixel.bottom / scale_));
+    }
+
+    Bounds GetBounds() const override {
+        return shape_->GetBounds().Offset(-x0_, -y0_).Scale(0, 0, scale_);
+    }
+
+    Rect GetDrawArea() const override { return GetBounds().GetRect(); }
+    bool IsExact() const override { return shape_->IsExact(); }
+    int GetNodeCount() const override { return 1 + shape_->GetNodeCount(); }
+
+    // pre-rendered pixels are only moved, so they are forwarded at
+    // scale 1 & views at whole pixels
+    bool GetRaster(Raster &raster) const override {
+        int dx = x0_, dy = y0_;
+        if (scale_ != 1.F || dx != x0_ || dy != y0_) return false;
+        if (!shape_->GetRaster(raster)) return false;
+        auto &area = raster.area;
+        area = Rect(area.left - dx, area.top - dy, area.right - dx,
+                area.bottom - dy);
+        return true;
+    }
+
+private:
+    ShapePtr shape_;
+    float x0_, y0_, scale_;
+};
+
+} // namespace cvf::shape
+
+#endif // CANVASFLAT_SHAPE_VIEW_H_
@@ -0,0 +1,51 @@
+#ifndef CANVASFLAT_UTIL_AFFINITY_H_
+#define CANVASFLAT_UTIL_AFFINITY_H_
+
+#if defined(__linux__)
+#include <sched.h>
+#include <pthread.h>
+#endif
+
+namespace cvf::util {
+
+// pin the current thread to a CPU in the scope, the last affinity is
+// restored on exit, nothing is done if 'cpu' is negative or pinning
+// is not supported by the platform
+class AffinityScope {
+public:
+    AffinityScope(int cpu) : pinned_(false) {
+#if defined(__linux__)
+        if (cpu < 0 || cpu >= CPU_SETSIZE) return;
+        auto self = pthread_self();
+        if (pthread_getaffinity_np(self, sizeof(last_), &last_)) return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pinned_ = !pthread_setaffinity_np(self, sizeof(set), &set);
+#else
+        static_cast<void>(cpu);
+#endif
+    }
+    ~AffinityScope() {
+#if defined(__linux__)
+        if (pinned_) {
+            pthread_setaffinity_np(pthread_self(), sizeof(last_), &last_);
+        }
+#endif
+    }
+
+    AffinityScope(const AffinityScope &) = delete;
+    AffinityScope &operator=(const AffinityScope &) = delete;
+
+    bool pinned() const { return pinned_; }
+
+private:
+    bool pinned_;
+#if defined(__linux__)
+    cpu_set_t last_;
+#endif
+};
+
+} // namespace cvf::util
+
+#endif // CANVASFLAT_UTIL_AFFINITY_H_
@@ -0,0 +1,41 @@
+#ifndef CANVASFLAT_UTIL_ALLOCATOR_H_
+#define CANVASFLAT_UTIL_ALLOCATOR_H_
+
+#include <new>
+#include <memory>
+#include <utility>
+
+namespace cvf::util {
+
+// allocator which default-initializes elements instead of zeroing them,
+// so resizing a vector of trivial types does not touch the memory, and
+// pages of large buffers are placed on the NUMA node of the thread
+// which writes them first
+template <typename T, typename Alloc = std::allocator<T>>
+class DefaultInitAllocator : public Alloc {
+public:
+    template <typename U>
+    struct rebind {
+        using other = DefaultInitAllocator<U, typename
+                std::allocator_traits<Alloc>::template rebind_alloc<U>>;
+    };
+
+    using Alloc::Alloc;
+
+    template <typename U>
+    void construct(U *p) {
+        ::new (static_cast<void *>(p)) U;
+    }
+    template <typename U, typename... Args>
+    void construct(U *p, Args &&...args) {
+        Traits::construct(static_cast<Alloc &>(*this), p,
+                std::forward<Args>(args)...);
+    }
+
+private:
+    using Traits = std::allocator_traits<Alloc>;
+};
+
+} // namespace cvf::util
+
+#endif // CANVASFLAT_UTIL_ALLOCATOR_H_
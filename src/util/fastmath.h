@@ -0,0 +1,220 @@
+#ifndef CANVASFLAT_UTIL_FASTMATH_H_
+#define CANVASFLAT_UTIL_FASTMATH_H_
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "mathutil.h"
+
+namespace cvf::util {
+
+// polynomial approximations of elementary functions, all of them are
+// branch free so that loops using them can be vectorized (GCC needs
+// '-fno-trapping-math' to if-convert the float selects), maximum errors
+// are measured over the whole float range unless otherwise noted
+
+inline std::uint32_t FloatBits(float x) {
+    std::uint32_t i;
+    std::memcpy(&i, &x, sizeof(i));
+    return i;
+}
+
+inline float BitsFloat(std::uint32_t i) {
+    float x;
+    std::memcpy(&x, &i, sizeof(x));
+    return x;
+}
+
+// 1 / sqrt(x), x > 0, max relative error 5e-6
+// bit level initial guess refined by two Newton steps
+inline float FastRsqrt(float x) {
+    auto y = BitsFloat(0x5f375a86 - (FloatBits(x) >> 1));
+    auto hx = x * 0.5F;
+    y = y * (1.5F - hx * y * y);
+    y = y * (1.5F - hx * y * y);
+    return y;
+}
+
+// sqrt(x), x >= 0, max relative error 5e-6
+inline float FastSqrt(float x) {
+    // compute first & select later, keeps the function if-convertible
+    auto r = x * FastRsqrt(x);
+    return x > 0.F ? r : 0.F;
+}
+
+// log2(x), x > 0 & normal, max absolute error 5e-6
+inline float FastLog2(float x) {
+    auto bits = FloatBits(x);
+    auto e = static_cast<int>((bits >> 23) & 0xff) - 127;
+    auto t = BitsFloat((bits & 0x7fffff) | 0x3f800000) - 1.F;
+    // Estrin's scheme, shorter dependency chain than Horner's
+    auto t2 = t * t, t4 = t2 * t2;
+    auto p01 = 3.68561410e-7F + 1.44264755F * t;
+    auto p23 = -0.720316064F + 0.472086916F * t;
+    auto p45 = -0.321960285F + 0.188752738F * t;
+    auto p67 = -0.0756513747F + 0.0144403525F * t;
+    auto p = (p01 + p23 * t2) + (p45 + p67 * t2) * t4;
+    return p + e;
+}
+
+// 2^x, max relative error 3e-7, result is flushed to zero below 2^-126
+inline float FastExp2(float x) {
+    // plain comparisons, 'fminf' & 'fmaxf' may not be inlined
+    x = x > 127.99F ? 127.99F : (x < -126.F ? -126.F : x);
+    // floor without calling libm
+    auto i = static_cast<int>(x);
+    i -= x < i;
+    auto t = x - i;
+    auto t2 = t * t, t4 = t2 * t2;
+    auto p01 = 0.999999898F + 0.693154490F * t;
+    auto p23 = 0.240141818F + 0.0558603371F * t;
+    auto p45 = 0.00894959042F + 0.00189375406F * t;
+    auto p = (p01 + p23 * t2) + p45 * t4;
+    auto e = static_cast<std::uint32_t>(i + 127) << 23;
+    return p * BitsFloat(e);
+}
+
+// x^y, x >= 0, max relative error about 2.1e-6 * max(1, |y * log2(x)|),
+// measured for x in (0, 4] & y in [-8, 8]
+inline float FastPow(float x, float y) {
+    auto r = FastExp2(y * FastLog2(x));
+    return x > 0.F ? r : 0.F;
+}
+
+// sin(x) & cos(x), max absolute error 4e-7 for |x| < 1e4
+inline void FastSinCos(float x, float &s, float &c) {
+    // reduce to [-pi, pi], then to [-pi/2, pi/2] by symmetry
+    // 2 * pi is split into two parts (Cody-Waite) to keep reduction exact
+    auto kf = x * (0.5F / PI) + 0.5F;
+    float k = static_cast<int>(kf) - (kf < static_cast<int>(kf));
+    auto r = (x - k * 6.28125F) - k * 1.93530717e-3F;
+    auto cr = r + PI_2;
+    cr = cr > PI ? cr - 2 * PI : cr;
+    auto fold = [](float v) {
+        return v > PI_2 ? PI - v : (v < -PI_2 ? -PI - v : v);
+    };
+    auto poly = [](float v) {
+        auto v2 = v * v;
+        auto p = 2.60510764e-6F;
+        p = p * v2 - 1.98090174e-4F;
+        p = p * v2 + 8.33305017e-3F;
+        p = p * v2 - 0.166666579F;
+        p = p * v2 + 0.999999996F;
+        return p * v;
+    };
+    s = poly(fold(r));
+    c = poly(fold(cr));
+}
+
+// atan2(y, x), max absolute error 4e-7 radians
+inline float FastAtan2(float y, float x) {
+    auto ax = std::fabs(x), ay = std::fabs(y);
+    auto mx = ax > ay ? ax : ay, mn = ax > ay ? ay : ax;
+    // select instead of an early return, atan2(0, 0) is 0
+    auto t = mx > 0.F ? mn / mx : 0.F, s = t * t;
+    auto p = -0.00455979199F;
+    p = p * s + 0.0237805186F;
+    p = p * s - 0.0588297531F;
+    p = p * s + 0.0986886546F;
+    p = p * s - 0.140032902F;
+    p = p * s + 0.199669618F;
+    p = p * s - 0.333318127F;
+    p = p * s + 0.999999882F;
+    auto r = p * t;
+    r = ay > ax ? PI_2 - r : r;
+    r = x < 0.F ? PI - r : r;
+    return y < 0.F ? -r : r;
+}
+
+// x^n by repeated squaring, n >= 0, negative n is taken as 0
+inline float IntPow(float x, int n) {
+    auto r = 1.F;
+    while (n > 0) {
+        if (n & 1) r *= x;
+        x *= x;
+        n >>= 1;
+    }
+    return r;
+}
+
+// precision of math functions used in SDF kernels,
+// it's set per thread, so each render can choose its own
+enum class MathPrecision : char {
+    Exact, Fast
+};
+
+inline MathPrecision &CurrentMathPrecision() {
+    thread_local MathPrecision precision = MathPrecision::Exact;
+    return precision;
+}
+
+inline bool IsFastMath() {
+    return CurrentMathPrecision() == MathPrecision::Fast;
+}
+
+// set math precision of current thread in a scope
+class MathPrecisionScope {
+public:
+    MathPrecisionScope(MathPrecision precision)
+            : last_(CurrentMathPrecision()) {
+        CurrentMathPrecision() = precision;
+    }
+    ~MathPrecisionScope() { CurrentMathPrecision() = last_; }
+
+private:
+    MathPrecision last_;
+};
+
+// math functions of each precision, kernels templated on them are
+// instantiated once per precision & have no branches inside
+struct ExactMath {
+    static float Sqrt(float x) { return std::sqrt(x); }
+    static float Pow(float x, float y) { return std::pow(x, y); }
+    static float Atan2(float y, float x) { return std::atan2(y, x); }
+    static void SinCos(float x, float &s, float &c) {
+        s = std::sin(x);
+        c = std::cos(x);
+    }
+};
+
+struct FastMath {
+    static float Sqrt(float x) { return FastSqrt(x); }
+    static float Pow(float x, float y) { return FastPow(x, y); }
+    static float Atan2(float y, float x) { return FastAtan2(y, x); }
+    static void SinCos(float x, float &s, float &c) { FastSinCos(x, s, c); }
+};
+
+// call 'func' with the math of current thread, precision is checked once
+// so that loops inside 'func' can be vectorized
+template <typename Func>
+inline decltype(auto) WithMath(Func func) {
+    if (IsFastMath()) return func(FastMath());
+    return func(ExactMath());
+}
+
+// dispatching versions, only for code outside of per-pixel loops
+inline float Sqrt(float x) {
+    return IsFastMath() ? FastMath::Sqrt(x) : ExactMath::Sqrt(x);
+}
+
+inline float Pow(float x, float y) {
+    return IsFastMath() ? FastMath::Pow(x, y) : ExactMath::Pow(x, y);
+}
+
+inline float Atan2(float y, float x) {
+    return IsFastMath() ? FastMath::Atan2(y, x) : ExactMath::Atan2(y, x);
+}
+
+inline void SinCos(float x, float &s, float &c) {
+    if (IsFastMath()) {
+        FastMath::SinCos(x, s, c);
+    }
+    else {
+        ExactMath::SinCos(x, s, c);
+    }
+}
+
+} // namespace cvf::util
+
+#endif // CANVASFLAT_UTIL_FASTMATH_H_
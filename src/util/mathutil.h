@@ -60,7 +60,7 @@ inline bool FloatEqual(float a, float b) {
 }
 
 // some other definitions
-inline bool RadiansNormalize(float radians) {
+inline float RadiansNormalize(float radians) {
     auto x = std::fmodf(radians, 2 * PI);
     return x < 0 ? x + 2 * PI : x;
 }
@@ -78,6 +78,41 @@ inline float LinearMapping(float value,
     }
 }
 
+// polynomial smooth minimum, values closer than 'k' are blended,
+// the result is at most k / 4 less than the minimum, & it's still
+// 1-Lipschitz if both values are
+inline float SmoothMin(float a, float b, float k) {
+    auto d = a - b, m = a < b ? a : b;
+    auto h = k - (d < 0.F ? -d : d);
+    h = h > 0.F ? h : 0.F;
+    return k > 0.F ? m - h * h / k * 0.25F : m;
+}
+
+inline float SmoothMax(float a, float b, float k) {
+    return -SmoothMin(-a, -b, k);
+}
+
+// fraction of a rectangle lying behind a straight edge, 'd' is the
+// signed distance from the rectangle center to the edge (negative if
+// the center is inside), 'u' & 'v' are half extents of the rectangle
+// projected onto the edge normal, the result is exact for a straight edge
+inline float EdgeCoverage(float d, float u, float v) {
+    if (u < v) {
+        auto t = u;
+        u = v;
+        v = t;
+    }
+    auto t = -d;
+    if (t <= -(u + v)) return 0.F;
+    if (t >= u + v) return 1.F;
+    if (v <= std::numeric_limits<float>::epsilon() * u) {
+        return (t + u) / (2 * u);
+    }
+    if (t <= v - u) return (t + u + v) * (t + u + v) / (8 * u * v);
+    if (t < u - v) return (t + u) / (2 * u);
+    return 1.F - (u + v - t) * (u + v - t) / (8 * u * v);
+}
+
 } // namespace cvf::util
 
 #endif // CANVASFLAT_UTIL_MATHUTIL_H_
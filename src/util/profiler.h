@@ -0,0 +1,168 @@
+#ifndef CANVASFLAT_UTIL_PROFILER_H_
+#define CANVASFLAT_UTIL_PROFILER_H_
+
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+
+namespace cvf::util {
+
+// counters of a profiled entry (a stage or a shape of render)
+struct ProfileEntry {
+    ProfileEntry() : ns(0), pixels_evaluated(0), pixels_blended(0),
+                     sdf_evaluations(0) {}
+
+    std::string name;
+    // wall time in nanoseconds
+    double ns;
+    long long pixels_evaluated, pixels_blended, sdf_evaluations;
+};
+
+// collects counters & timeline of entries
+// each thread writes to its own slot without locking,
+// slots are merged into entries by 'Stop'
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    class Slot {
+    public:
+        ProfileEntry &entry(int index) { return entries_[index]; }
+
+        // record a time span of entry, both for counters & timeline
+        void AddSpan(int index, Clock::time_point begin,
+                Clock::time_point end) {
+            auto ns = std::chrono::duration<double, std::nano>(
+                    end - begin).count();
+            entries_[index].ns += ns;
+            spans_.push_back({index, begin, ns});
+        }
+
+    private:
+        friend class Profiler;
+
+        struct Span {
+            int index;
+            Clock::time_point begin;
+            double ns;
+        };
+
+        std::thread::id thread_id_;
+        std::vector<ProfileEntry> entries_;
+        std::vector<Span> spans_;
+    };
+
+    Profiler() : running_(false) {}
+
+    // clear all counters, 'count' is the number of entries
+    void Start(int count) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.assign(count, ProfileEntry());
+        slots_.clear();
+        start_ = Clock::now();
+        running_ = true;
+    }
+
+    void set_name(int index, const std::string &name) {
+        entries_[index].name = name;
+    }
+
+    // get the slot of current thread
+    Slot &GetSlot() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto id = std::this_thread::get_id();
+        for (const auto &i : slots_) {
+            if (i->thread_id_ == id) return *i;
+        }
+        slots_.push_back(std::make_unique<Slot>());
+        auto &slot = *slots_.back();
+        slot.thread_id_ = id;
+        slot.entries_.resize(entries_.size());
+        return slot;
+    }
+
+    // merge slots of all threads
+    void Stop() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        for (const auto &slot : slots_) {
+            for (std::size_t i = 0; i < entries_.size(); ++i) {
+                const auto &e = slot->entries_[i];
+                entries_[i].ns += e.ns;
+                entries_[i].pixels_evaluated += e.pixels_evaluated;
+                entries_[i].pixels_blended += e.pixels_blended;
+                entries_[i].sdf_evaluations += e.sdf_evaluations;
+            }
+        }
+        running_ = false;
+    }
+
+    // print entries sorted by wall time
+    void Report(std::FILE *fp) const {
+        std::vector<const ProfileEntry *> sorted;
+        double total = 0;
+        for (const auto &i : entries_) {
+            sorted.push_back(&i);
+            total += i.ns;
+        }
+        std::stable_sort(sorted.begin(), sorted.end(),
+                [](const ProfileEntry *a, const ProfileEntry *b) {
+                    return a->ns > b->ns;
+                });
+        std::fprintf(fp, "%-16s %10s %6s %12s %12s %14s\n", "entry",
+                "time(ms)", "%", "evaluated", "blended", "sdf evals");
+        for (const auto &i : sorted) {
+            std::fprintf(fp, "%-16s %10.3f %6.2f %12lld %12lld %14lld\n",
+                    i->name.c_str(), i->ns / 1e6,
+                    total > 0 ? i->ns / total * 100 : 0.,
+                    i->pixels_evaluated, i->pixels_blended,
+                    i->sdf_evaluations);
+        }
+        std::fprintf(fp, "%-16s %10.3f\n", "total", total / 1e6);
+    }
+
+    // export timeline as Chrome trace event JSON,
+    // which can be opened by 'chrome://tracing' or Perfetto
+    bool ExportTrace(const char *path) const {
+        auto fp = std::fopen(path, "w");
+        if (!fp) return false;
+        std::fprintf(fp, "{\"traceEvents\": [\n");
+        bool first = true;
+        for (std::size_t tid = 0; tid < slots_.size(); ++tid) {
+            for (const auto &span : slots_[tid]->spans_) {
+                const auto &entry = entries_[span.index];
+                auto ts = std::chrono::duration<double, std::micro>(
+                        span.begin - start_).count();
+                std::fprintf(fp, "%s  {\"name\": \"%s\", \"ph\": \"X\", "
+                        "\"pid\": 0, \"tid\": %zu, \"ts\": %.3f, "
+                        "\"dur\": %.3f, \"args\": {\"evaluated\": %lld, "
+                        "\"blended\": %lld, \"sdf_evaluations\": %lld}}",
+                        first ? "" : ",\n", entry.name.c_str(), tid, ts,
+                        span.ns / 1e3, entry.pixels_evaluated,
+                        entry.pixels_blended, entry.sdf_evaluations);
+                first = false;
+            }
+        }
+        std::fprintf(fp, "\n]}\n");
+        std::fclose(fp);
+        return true;
+    }
+
+    const std::vector<ProfileEntry> &entries() const { return entries_; }
+
+private:
+    std::mutex mutex_;
+    bool running_;
+    Clock::time_point start_;
+    std::vector<ProfileEntry> entries_;
+    std::vector<std::unique_ptr<Slot>> slots_;
+};
+
+} // namespace cvf::util
+
+#endif // CANVASFLAT_UTIL_PROFILER_H_
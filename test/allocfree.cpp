@@ -0,0 +1,129 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <new>
+
+#include "../src/render/basic.h"
+#include "../src/render/parallel.h"
+#include "../src/canvas.h"
+#include "../src/container/pngcont.h"
+#include "../src/container/ppmcont.h"
+#include "../src/util/mathutil.h"
+
+#include "../src/shape/rectangle.h"
+#include "../src/shape/operation.h"
+#include "../src/shape/circle.h"
+#include "../src/shape/capsule.h"
+#include "../src/shape/layer.h"
+
+namespace {
+
+// count of allocations, counted by global 'operator new'
+std::atomic<std::uint64_t> alloc_count(0);
+
+} // namespace
+
+// not inlined, otherwise GCC warns about 'free' on 'new'-ed pointers
+[[gnu::noinline]] void *operator new(std::size_t size) {
+    ++alloc_count;
+    if (auto p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void *p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void *p, std::size_t) noexcept {
+    std::free(p);
+}
+
+using namespace cvf;
+using namespace cvf::render;
+using namespace cvf::container;
+using namespace cvf::color;
+using namespace cvf::util;
+using namespace cvf::shape;
+
+namespace {
+
+// warm-up frames, which may allocate buffers & threads
+constexpr int kWarmUp = 2;
+// frames which must not allocate
+constexpr int kFrames = 4;
+
+void BuildScene(Canvas &canvas) {
+    auto cx = canvas.width() / 2.F, cy = canvas.height() / 2.F;
+    canvas.set_backcolor(Color(SolidColor(0xF0F0F0), SolidColor(0xC0D0E0),
+            PI / 5));
+    ShapePtr bg = std::make_shared<Rectangle>(cx - 120, cy - 120, 240);
+    bg = std::make_shared<Operation>(Operation::Opcode::Round, bg, 60);
+    bg->set_color(Color(0x0278E2, 0x78EEFCU));
+    canvas.AddShape(bg);
+    auto sun = std::make_shared<Circle>(cx - 40, cy - 30, 70);
+    sun->set_color(Color([](float x, float y) {
+        return SolidColor(0xFB, 0xC0 + x * 40, 0x36 + y * 40, 1.F);
+    }));
+    canvas.AddShape(sun);
+    auto layer = std::make_shared<Layer>();
+    auto cloud = std::make_shared<Capsule>(cx - 60, cy + 40, cx + 70,
+            cy + 40, 40);
+    cloud->set_color(SolidColor(0xFFFFFF, 0.8F));
+    layer->AddShape(cloud);
+    layer->set_opacity(0.9F);
+    canvas.AddShape(layer);
+}
+
+// count allocations of redraws & exports after warm-up
+bool Check(const char *name, RenderPtr render, ImageContainerPtr cont,
+        const char *path) {
+    Canvas canvas(320, 240);
+    BuildScene(canvas);
+    canvas.set_render(std::move(render));
+    canvas.set_image_container(std::move(cont));
+    std::uint64_t count = 0;
+    for (int i = 0; i < kWarmUp + kFrames; ++i) {
+        auto last = alloc_count.load();
+        canvas.Redraw();
+        canvas.Export(path);
+        if (i >= kWarmUp) count += alloc_count - last;
+    }
+    std::printf("%-16s %llu allocations in %d frames\n", name,
+            static_cast<unsigned long long>(count), kFrames);
+    return !count;
+}
+
+RenderPtr MakeBasic(bool high_precision) {
+    auto render = std::make_unique<BasicRender>();
+    render->set_anti_aliasing(true);
+    render->set_high_precision(high_precision);
+    return render;
+}
+
+RenderPtr MakeParallel(bool high_precision) {
+    auto render = std::make_unique<ParallelRender>(4);
+    render->set_anti_aliasing(true);
+    render->set_high_precision(high_precision);
+    return render;
+}
+
+} // namespace
+
+// steady state redraws & exports must not allocate, returns nonzero
+// if any of them allocates
+int main(int argc, const char *argv[]) {
+    auto dir = argc > 1 ? argv[1] : "out";
+    std::string png = std::string(dir) + "/allocfree.png";
+    std::string ppm = std::string(dir) + "/allocfree.ppm";
+    auto make_png = [] { return std::make_unique<PngContainer>(); };
+    auto make_ppm = [] {
+        return std::make_unique<PpmContainer>(PpmContainer::Format::PPM,
+                true);
+    };
+    bool ok = true;
+    ok &= Check("basic", MakeBasic(false), make_png(), png.c_str());
+    ok &= Check("basic hp", MakeBasic(true), make_png(), png.c_str());
+    ok &= Check("parallel", MakeParallel(false), make_png(), png.c_str());
+    ok &= Check("parallel hp", MakeParallel(true), make_ppm(),
+            ppm.c_str());
+    return ok ? 0 : 1;
+}
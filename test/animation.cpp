@@ -0,0 +1,60 @@
+#include <cmath>
+#include <memory>
+
+#include "../src/render/basic.h"
+#include "../src/animation.h"
+#include "../src/container/framesink.h"
+#include "../src/container/pngcont.h"
+#include "../src/util/mathutil.h"
+
+#include "../src/shape/rectangle.h"
+#include "../src/shape/operation.h"
+#include "../src/shape/circle.h"
+#include "../src/shape/capsule.h"
+#include "../src/shape/animated.h"
+
+using namespace cvf;
+using namespace cvf::render;
+using namespace cvf::container;
+using namespace cvf::color;
+using namespace cvf::util;
+using namespace cvf::shape;
+
+int main(int argc, const char *argv[]) {
+    // create render
+    auto render = std::make_unique<BasicRender>();
+    render->set_anti_aliasing(true);
+    // create animation
+    Animation anim(512, 512);
+    anim.set_backcolor(0xFFFFFF);
+    anim.set_render(std::move(render));
+    // static icon background
+    ShapePtr bg = std::make_shared<Rectangle>(156, 156, 200);
+    bg = std::make_shared<Operation>(Operation::Opcode::Round, bg, 90);
+    bg->set_color(Color(0x0278E2, 0x78EEFCU));
+    anim.AddShape(bg);
+    // sun rising & pulsing
+    auto sun = std::make_shared<AnimatedShape>(
+            std::make_shared<Circle>(200, 230, 70));
+    sun->set_offset_y([](float t) { return 40 * (1 - t); });
+    sun->set_scale([](float t) { return 1 + 0.1F * std::sin(t * 2 * PI); });
+    sun->set_color_track([](float t) {
+        return SolidColor(0xFBC036, 0.6F + 0.4F * t);
+    });
+    anim.AddShape(sun);
+    // cloud drifting
+    ShapePtr cloud = std::make_shared<Capsule>(200, 300, 330, 300, 45);
+    cloud = std::make_shared<Operation>(Operation::Opcode::Union, cloud,
+            std::make_shared<Circle>(270, 280, 70));
+    cloud->set_color(Color(SolidColor(0xFFFFFF, 0.75),
+            SolidColor(0xFFFFFF, 0.97)));
+    auto drift = std::make_shared<AnimatedShape>(cloud);
+    drift->set_offset_x([](float t) { return 30 * std::sin(t * PI); });
+    drift->set_rotation([](float t) { return 0.1F * std::sin(t * PI); });
+    anim.AddShape(drift);
+    // render frames
+    SequenceSink sink(argc > 1 ? argv[1] : "out/anim%02d.png",
+            std::make_unique<PngContainer>());
+    anim.Render(0.F, 1.F / 24, 24, sink);
+    return 0;
+}
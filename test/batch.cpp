@@ -0,0 +1,118 @@
+#include <cstdio>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <limits>
+
+#include "../src/render/basic.h"
+#include "../src/canvas.h"
+#include "../src/container/pngcont.h"
+
+#include "../src/shape/circle.h"
+#include "../src/shape/capsule.h"
+#include "../src/shape/batch.h"
+#include "../bench/scenes.h"
+
+using namespace cvf;
+using namespace cvf::render;
+using namespace cvf::container;
+using namespace cvf::color;
+using namespace cvf::shape;
+
+namespace {
+
+constexpr int kSize = 256;
+
+// instances of batches & the same instances as separate shapes
+struct Batches {
+    std::shared_ptr<CircleBatch> circles;
+    std::shared_ptr<CapsuleBatch> capsules;
+    ShapeList circle_shapes, capsule_shapes;
+};
+
+Batches MakeBatches(float blend) {
+    Batches b = {std::make_shared<CircleBatch>(blend),
+            std::make_shared<CapsuleBatch>(blend), {}, {}};
+    bench::Random random(20181115);
+    for (int i = 0; i < 200; ++i) {
+        auto x = random.Next(0, kSize), y = random.Next(0, kSize);
+        auto r = random.Next(2, 12);
+        b.circles->Add(x, y, r);
+        b.circle_shapes.push_back(std::make_shared<Circle>(x, y, r));
+        auto x1 = x + random.Next(-30, 30), y1 = y + random.Next(-30, 30);
+        r = random.Next(1, 6);
+        b.capsules->Add(x, y, x1, y1, r);
+        b.capsule_shapes.push_back(std::make_shared<Capsule>(x, y, x1, y1,
+                r));
+    }
+    return b;
+}
+
+// maximum difference of SDF between batch & union of shapes
+float CompareUnion(const Shape &batch, const ShapeList &shapes) {
+    float error = 0;
+    for (int y = -16; y < kSize + 16; y += 3) {
+        for (int x = -16; x < kSize + 16; x += 3) {
+            auto sdf = std::numeric_limits<float>::max();
+            for (const auto &i : shapes) {
+                sdf = std::fminf(sdf, i->GetSDF(x + .5F, y + .5F));
+            }
+            error = std::fmaxf(error,
+                    std::fabsf(sdf - batch.GetSDF(x + .5F, y + .5F)));
+        }
+    }
+    return error;
+}
+
+// maximum difference between rows & points clamped to the margin
+float CompareRows(const Shape &batch) {
+    std::vector<float> row(kSize + 32);
+    float error = 0;
+    for (int y = -16; y < kSize + 16; ++y) {
+        batch.GetSDFRow(-15.5F, y + .5F, row.size(), row.data());
+        for (int i = 0; i < static_cast<int>(row.size()); ++i) {
+            auto sdf = std::fminf(batch.GetSDF(i - 15.5F, y + .5F),
+                    BatchShape::kCullMargin);
+            error = std::fmaxf(error, std::fabsf(sdf - row[i]));
+        }
+    }
+    return error;
+}
+
+} // namespace
+
+// check circle & capsule batches against separate shapes, & their rows
+// against single points, returns nonzero if any of them differs
+int main(int argc, const char *argv[]) {
+    bool ok = true;
+    auto hard = MakeBatches(0);
+    auto circle_error = CompareUnion(*hard.circles, hard.circle_shapes);
+    auto capsule_error = CompareUnion(*hard.capsules, hard.capsule_shapes);
+    std::printf("union error: circles %g, capsules %g\n", circle_error,
+            capsule_error);
+    ok &= circle_error < 1e-3F && capsule_error < 1e-3F;
+    for (float blend : {0.F, 8.F, 24.F}) {
+        auto b = MakeBatches(blend);
+        auto circle_rows = CompareRows(*b.circles);
+        auto capsule_rows = CompareRows(*b.capsules);
+        std::printf("blend %g, row error: circles %g, capsules %g\n",
+                blend, circle_rows, capsule_rows);
+        // rows compute offsets in a different order
+        ok &= circle_rows < 1e-4F && capsule_rows < 1e-4F;
+    }
+    // draw blended batches
+    auto b = MakeBatches(6);
+    b.circles->set_color(Color(0xF0C040, 0.8F));
+    b.capsules->set_color(Color(0x40A0F0, 0.8F));
+    auto render = std::make_unique<BasicRender>();
+    render->set_anti_aliasing(true);
+    Canvas canvas(kSize, kSize);
+    canvas.set_backcolor(0x181818);
+    canvas.AddShape(b.circles);
+    canvas.AddShape(b.capsules);
+    canvas.set_render(std::move(render));
+    canvas.set_image_container(std::make_unique<PngContainer>());
+    canvas.Redraw();
+    canvas.Export(argc > 1 ? argv[1] : "out/batch.png");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+#include <cstdio>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../src/shape/cached.h"
+#include "../src/shape/circle.h"
+#include "../src/shape/rectangle.h"
+#include "../src/shape/operation.h"
+
+using namespace cvf::shape;
+
+namespace {
+
+// maximum error of cached SDF near the boundary, where it is visible,
+// & between rows & single points of the cache
+bool CheckError(const ShapePtr &shape, float resolution, float limit) {
+    CachedShape cached(shape, resolution);
+    auto area = shape->GetDrawArea();
+    int count = area.right - area.left + 1;
+    std::vector<float> row(count);
+    float error = 0, row_error = 0;
+    for (int y = area.top; y <= area.bottom; ++y) {
+        cached.GetSDFRow(area.left + .5F, y + .5F, count, row.data());
+        for (int i = 0; i < count; ++i) {
+            auto x = area.left + i + .5F;
+            auto sdf = cached.GetSDF(x, y + .5F);
+            row_error = std::fmaxf(row_error, std::fabsf(sdf - row[i]));
+            // off the samples of grid, which are exact
+            auto px = x + .3F, py = y + .7F;
+            auto exact = shape->GetSDF(px, py);
+            if (std::fabsf(exact) > 2.F) continue;
+            error = std::fmaxf(error,
+                    std::fabsf(cached.GetSDF(px, py) - exact));
+        }
+    }
+    std::printf("resolution %g: error %g, row error %g\n", resolution,
+            error, row_error);
+    return error <= limit && row_error < 1e-4F;
+}
+
+// circles of the same radius get fields of the same size
+ShapePtr MakeCircle(float x) {
+    return std::make_shared<Circle>(x, 64, 40);
+}
+
+// least recently used fields are dropped once the budget is exceeded,
+// & fields of destroyed shapes are dropped first
+bool CheckEviction() {
+    auto &cache = FieldCache::Get();
+    cache.Clear();
+    auto a = MakeCircle(64), b = MakeCircle(128), c = MakeCircle(192);
+    auto field_a = cache.Acquire(a, 1.F);
+    auto size = cache.used();
+    bool ok = true;
+    // room for two fields
+    cache.set_budget(size * 2);
+    auto field_b = cache.Acquire(b, 1.F);
+    ok &= cache.used() == size * 2;
+    // touch 'a', so that 'b' is the least recently used one
+    ok &= cache.Acquire(a, 1.F) == field_a;
+    cache.Acquire(c, 1.F);
+    ok &= cache.used() == size * 2;
+    ok &= cache.Acquire(a, 1.F) == field_a;
+    std::printf("eviction: used %zu of %zu bytes\n", cache.used(),
+            cache.budget());
+    // 'b' was dropped, it's sampled again & replaces 'c'
+    auto field_b2 = cache.Acquire(b, 1.F);
+    ok &= field_b2 != field_b && cache.used() == size * 2;
+    // expired shapes are dropped without exceeding the budget
+    b.reset();
+    cache.set_budget(size * 2);
+    ok &= cache.used() == size;
+    ok &= cache.Acquire(a, 1.F) == field_a;
+    cache.set_budget(64 << 20);
+    cache.Clear();
+    return ok;
+}
+
+// threads sampling the same shape at once share the first field
+bool CheckRace() {
+    auto &cache = FieldCache::Get();
+    cache.Clear();
+    auto shape = MakeCircle(64);
+    std::vector<SDFFieldPtr> fields(8);
+    std::vector<std::thread> threads;
+    for (auto &field : fields) {
+        threads.emplace_back([&] { field = cache.Acquire(shape, 4.F); });
+    }
+    for (auto &thread : threads) thread.join();
+    bool ok = cache.used() == fields[0]->bytes();
+    for (auto &field : fields) ok &= field == fields[0];
+    ok &= cache.Acquire(shape, 4.F) == fields[0];
+    std::printf("race: used %zu bytes\n", cache.used());
+    cache.Clear();
+    return ok;
+}
+
+} // namespace
+
+// check error of cached fields, eviction & races of the field cache,
+// returns nonzero if any check fails
+int main() {
+    ShapePtr rect = std::make_shared<Rectangle>(20, 20, 120, 80);
+    rect = std::make_shared<Operation>(Operation::Opcode::Round, rect, 16);
+    ShapePtr circle = std::make_shared<Circle>(120, 110, 36);
+    ShapePtr shape = std::make_shared<Operation>(Operation::Opcode::Union,
+            rect, circle);
+    bool ok = true;
+    ok &= CheckError(shape, 1.F, 0.3F);
+    ok &= CheckError(shape, 2.F, 0.15F);
+    auto eviction = CheckEviction();
+    std::printf("eviction %s\n", eviction ? "passed" : "failed");
+    ok &= eviction;
+    auto race = CheckRace();
+    std::printf("race %s\n", race ? "passed" : "failed");
+    ok &= race;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+#include <cstdio>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "../src/shape/expr.h"
+#include "../src/shape/operation.h"
+#include "../src/util/fastmath.h"
+#include "../src/util/mathutil.h"
+
+using namespace cvf;
+using namespace cvf::shape;
+using Opcode = Operation::Opcode;
+
+namespace {
+
+constexpr int kSize = 256;
+
+ShapePtr MakeOp(Opcode opcode, ShapePtr a, ShapePtr b) {
+    return std::make_shared<Operation>(opcode, a, b);
+}
+
+ShapePtr MakeOp(Opcode opcode, ShapePtr a, ShapePtr b, float param) {
+    return std::make_shared<Operation>(opcode, a, b, param);
+}
+
+ShapePtr MakeOp(Opcode opcode, ShapePtr a, float param) {
+    return std::make_shared<Operation>(opcode, a, param);
+}
+
+// badge made of every kind of node as an expression template
+ShapePtr MakeExprBadge() {
+    namespace e = expr;
+    auto body = e::MakeRound(e::Rectangle(40, 60, 120, 90), 12)
+            | e::Circle(170, 90, 50);
+    auto holed = body - e::Capsule(70, 100, 150, 130, 10);
+    auto blended = e::MakeSmoothUnion(holed, e::Squircle(90, 190, 36, 2),
+            16);
+    auto cut = e::MakeSmoothDifference(blended, e::Circle(200, 60, 20), 8);
+    auto clip = e::MakeSmoothIntersection(cut,
+            e::Rectangle(20, 20, 220, 220), 6);
+    auto turned = e::MakeRotate(e::MakeScale(clip, 0.9F), util::PI / 7);
+    auto ring = e::MakeOutline(e::Circle(128, 128, 100), 6);
+    auto moved = e::MakeOffset(e::MakeBlur(e::Circle(60, 200, 24), 4), 12,
+            -8);
+    auto clipped = (turned | ring) & e::Rectangle(0, 0, kSize);
+    return e::MakeShape(clipped | moved);
+}
+
+// the same badge as a tree of 'Operation'
+ShapePtr MakeOperationBadge() {
+    ShapePtr rect = std::make_shared<Rectangle>(40, 60, 120, 90);
+    auto body = MakeOp(Opcode::Union, MakeOp(Opcode::Round, rect, 12),
+            std::make_shared<Circle>(170, 90, 50));
+    auto holed = MakeOp(Opcode::Difference, body,
+            std::make_shared<Capsule>(70, 100, 150, 130, 10));
+    auto blended = MakeOp(Opcode::SmoothUnion, holed,
+            std::make_shared<Squircle>(90, 190, 36, 2), 16);
+    auto cut = MakeOp(Opcode::SmoothDifference, blended,
+            std::make_shared<Circle>(200, 60, 20), 8);
+    auto clip = MakeOp(Opcode::SmoothIntersection, cut,
+            std::make_shared<Rectangle>(20, 20, 220, 220), 6);
+    auto turned = MakeOp(Opcode::Rotate, MakeOp(Opcode::Scale, clip, 0.9F),
+            util::PI / 7);
+    auto ring = MakeOp(Opcode::Outline,
+            std::make_shared<Circle>(128, 128, 100), 6);
+    auto blur = MakeOp(Opcode::Blur, std::make_shared<Circle>(60, 200, 24),
+            4);
+    auto moved = MakeOp(Opcode::OffsetY, MakeOp(Opcode::OffsetX, blur, 12),
+            -8);
+    auto clipped = MakeOp(Opcode::Intersection,
+            MakeOp(Opcode::Union, turned, ring),
+            std::make_shared<Rectangle>(0, 0, kSize));
+    return MakeOp(Opcode::Union, clipped, moved);
+}
+
+// maximum difference of SDF between two shapes, by rows & by points
+float Compare(const Shape &a, const Shape &b) {
+    std::vector<float> row(kSize + 32);
+    float error = 0;
+    for (int y = -16; y < kSize + 16; ++y) {
+        a.GetSDFRow(-15.5F, y + .5F, row.size(), row.data());
+        for (int i = 0; i < static_cast<int>(row.size()); ++i) {
+            auto x = i - 15.5F;
+            auto sdf = b.GetSDF(x, y + .5F);
+            error = std::fmaxf(error, std::fabsf(sdf - row[i]));
+            error = std::fmaxf(error, std::fabsf(sdf - a.GetSDF(x, y + .5F)));
+        }
+    }
+    return error;
+}
+
+} // namespace
+
+// check an expression tree against the equivalent operation tree with
+// both math precisions, returns nonzero if their SDFs differ
+int main() {
+    auto expr = MakeExprBadge(), op = MakeOperationBadge();
+    bool ok = true;
+    for (auto precision : {util::MathPrecision::Exact,
+            util::MathPrecision::Fast}) {
+        util::MathPrecisionScope scope(precision);
+        auto error = Compare(*expr, *op);
+        auto area = expr->GetDrawArea(), op_area = op->GetDrawArea();
+        bool same_area = area.left == op_area.left &&
+                area.top == op_area.top && area.right == op_area.right &&
+                area.bottom == op_area.bottom;
+        std::printf("%s math: error %g, nodes %d/%d, draw area %s\n",
+                util::IsFastMath() ? "fast" : "exact", error,
+                expr->GetNodeCount(), op->GetNodeCount(),
+                same_area ? "same" : "different");
+        ok &= error < 1e-4F && same_area && expr->IsExact() == op->IsExact();
+    }
+    return ok ? 0 : 1;
+}
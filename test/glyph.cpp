@@ -0,0 +1,201 @@
+#include <cstdio>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <limits>
+
+#include "../src/render/basic.h"
+#include "../src/canvas.h"
+#include "../src/container/pngcont.h"
+#include "../src/util/mathutil.h"
+
+#include "../src/shape/path.h"
+
+using namespace cvf;
+using namespace cvf::render;
+using namespace cvf::container;
+using namespace cvf::color;
+using namespace cvf::util;
+using namespace cvf::shape;
+
+namespace {
+
+// path & the same outline as dense polylines, whose distances are
+// found by brute force
+struct Outline {
+    static constexpr int kCurveSteps = 512;
+
+    struct Point {
+        float x, y;
+    };
+
+    void MoveTo(float x, float y) {
+        path->MoveTo(x, y);
+        contours.push_back({{x, y}});
+    }
+    void LineTo(float x, float y) {
+        path->LineTo(x, y);
+        contours.back().push_back({x, y});
+    }
+    void QuadTo(float cx, float cy, float x, float y) {
+        path->QuadTo(cx, cy, x, y);
+        auto p0 = contours.back().back();
+        for (int i = 1; i <= kCurveSteps; ++i) {
+            float t = static_cast<float>(i) / kCurveSteps, u = 1 - t;
+            contours.back().push_back({
+                    u * u * p0.x + 2 * u * t * cx + t * t * x,
+                    u * u * p0.y + 2 * u * t * cy + t * t * y});
+        }
+    }
+    // contours are closed anyway
+    void Close() { path->Close(); }
+
+    float GetDistance(float x, float y) const {
+        auto dist = std::numeric_limits<float>::max();
+        for (const auto &contour : contours) {
+            for (std::size_t i = 0; i < contour.size(); ++i) {
+                const auto &a = contour[i];
+                const auto &b = contour[(i + 1) % contour.size()];
+                auto dx = b.x - a.x, dy = b.y - a.y;
+                auto len = dx * dx + dy * dy;
+                auto h = len > 0 ? ((x - a.x) * dx + (y - a.y) * dy) / len
+                        : 0.F;
+                h = Min(Max(h, 0.F), 1.F);
+                auto ex = x - a.x - dx * h, ey = y - a.y - dy * h;
+                dist = Min(dist, std::sqrtf(ex * ex + ey * ey));
+            }
+        }
+        return dist;
+    }
+
+    std::shared_ptr<Path> path = std::make_shared<Path>();
+    std::vector<std::vector<Point>> contours;
+};
+
+// heart made of curves
+Outline MakeHeart(float x, float y, float size) {
+    Outline heart;
+    heart.MoveTo(x, y - size * 0.25F);
+    heart.QuadTo(x + size * 0.3F, y - size * 0.8F, x + size * 0.55F,
+            y - size * 0.35F);
+    heart.QuadTo(x + size * 0.7F, y, x, y + size * 0.6F);
+    heart.QuadTo(x - size * 0.7F, y, x - size * 0.55F, y - size * 0.35F);
+    heart.QuadTo(x - size * 0.3F, y - size * 0.8F, x, y - size * 0.25F);
+    heart.Close();
+    return heart;
+}
+
+// ring with a wavy outer contour, the inner contour goes the other way
+// & cuts a hole
+Outline MakeRing(float x, float y, float r, int waves) {
+    Outline ring;
+    auto step = 2 * PI / waves;
+    ring.MoveTo(x + r, y);
+    for (int i = 0; i < waves; ++i) {
+        auto a = step * (i + 0.5F), b = step * (i + 1);
+        auto c = r * (i % 2 ? 0.8F : 1.25F);
+        ring.QuadTo(x + c * std::cos(a), y + c * std::sin(a),
+                x + r * std::cos(b), y + r * std::sin(b));
+    }
+    ring.MoveTo(x + r * 0.5F, y);
+    for (int i = 1; i <= 32; ++i) {
+        auto a = -2 * PI * i / 32;
+        ring.LineTo(x + r * 0.5F * std::cos(a), y + r * 0.5F * std::sin(a));
+    }
+    ring.Close();
+    return ring;
+}
+
+// star of lines, the outline does not cross itself
+Outline MakeStar(float x, float y, float r) {
+    Outline star;
+    star.MoveTo(x, y - r);
+    for (int i = 1; i < 10; ++i) {
+        auto a = PI * i / 5, l = i % 2 ? r * 0.4F : r;
+        star.LineTo(x + l * std::sin(a), y - l * std::cos(a));
+    }
+    star.Close();
+    return star;
+}
+
+// bars as separate contours, rows through them cross more than the 64
+// edges rows keep sorted, so signs are taken point by point
+Outline MakeComb(float x, float y, int bars) {
+    Outline comb;
+    for (int i = 0; i < bars; ++i) {
+        auto x0 = x + i * 5.F;
+        comb.MoveTo(x0, y);
+        comb.LineTo(x0 + 2.5F, y);
+        comb.LineTo(x0 + 2.5F, y + 40);
+        comb.LineTo(x0, y + 40);
+        comb.Close();
+    }
+    return comb;
+}
+
+// rows against single points, which are clamped to the margin, & the
+// distances of points against brute force, both near the outline &
+// far out of the grid, where the search of rings stops early
+bool Check(const char *name, const Outline &outline) {
+    const auto &path = *outline.path;
+    auto area = path.GetDrawArea();
+    int x0 = area.left - 24, count = area.right - area.left + 49;
+    std::vector<float> row(count);
+    int signs = 0;
+    float row_error = 0, error = 0;
+    for (int y = area.top - 24; y <= area.bottom + 24; ++y) {
+        path.GetSDFRow(x0 + .5F, y + .5F, count, row.data());
+        for (int i = 0; i < count; ++i) {
+            auto sdf = path.GetSDF(x0 + i + .5F, y + .5F);
+            signs += (sdf < 0) != (row[i] < 0);
+            auto clamped = Min(std::fabsf(sdf), Path::kCullMargin);
+            row_error = Max(row_error, std::fabsf(clamped
+                    - std::fabsf(row[i])));
+        }
+    }
+    for (float y = area.top - 300; y <= area.bottom + 300; y += 7.3F) {
+        for (float x = area.left - 300; x <= area.right + 300; x += 7.3F) {
+            auto dist = std::fabsf(path.GetSDF(x, y));
+            error = Max(error, std::fabsf(dist - outline.GetDistance(x, y)));
+        }
+    }
+    std::printf("%s: %d signs differ, row error %g, distance error %g\n",
+            name, signs, row_error, error);
+    return !signs && row_error < 1e-4F && error < 1e-3F;
+}
+
+} // namespace
+
+// usage: glyph [output png]
+// check rows & distances of paths, then draw them, returns nonzero
+// if any check fails
+int main(int argc, const char *argv[]) {
+    // create render
+    auto render = std::make_unique<BasicRender>();
+    render->set_anti_aliasing(true);
+    // create canvas
+    Canvas canvas(768, 256);
+    canvas.set_backcolor(Color(SolidColor(0x202838), SolidColor(0x384858),
+            PI / 2));
+    canvas.set_render(std::move(render));
+    canvas.set_image_container(std::make_unique<PngContainer>());
+    // add glyph-like paths
+    auto heart = MakeHeart(128, 128, 180);
+    auto ring = MakeRing(384, 128, 80, 24);
+    auto star = MakeStar(640, 138, 100);
+    bool ok = Check("heart", heart);
+    ok &= Check("ring", ring);
+    ok &= Check("star", star);
+    ok &= Check("comb", MakeComb(100, 100, 40));
+    heart.path->set_color(Color(0xF04060, 0xF0A0B0U));
+    canvas.AddShape(heart.path);
+    ring.path->set_color(Color(Color::ColorType::Radial, 0xFFE070,
+            0xF08020, 0.F, 1.F, 0.F));
+    canvas.AddShape(ring.path);
+    star.path->set_color(SolidColor(0x70D0F0, 0.9F));
+    canvas.AddShape(star.path);
+    // draw & export
+    canvas.Redraw();
+    canvas.Export(argc > 1 ? argv[1] : "out/glyph.png");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+#include <cstdio>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "../src/render/basic.h"
+#include "../src/render/mipmap.h"
+#include "../src/canvas.h"
+#include "../src/container/ppmcont.h"
+#include "../src/color/gamma.h"
+#include "../src/util/mathutil.h"
+
+#include "../src/shape/circle.h"
+#include "../src/shape/rectangle.h"
+
+using namespace cvf;
+using namespace cvf::render;
+using namespace cvf::container;
+using namespace cvf::color;
+using namespace cvf::util;
+using namespace cvf::shape;
+
+namespace {
+
+// columns of black & white must be averaged in linear light,
+// which is not the middle of 8-bit sRGB
+bool CheckStripes() {
+    constexpr int kWidth = 8, kHeight = 4;
+    std::vector<unsigned char> stripes(kWidth * kHeight * 3);
+    for (int i = 0; i < kWidth * kHeight; ++i) {
+        auto v = i % 2 ? 255 : 0;
+        for (int c = 0; c < 3; ++c) stripes[i * 3 + c] = v;
+    }
+    Mipmap mipmap;
+    mipmap.Build(stripes.data(), kWidth, kHeight, PixelFormat::RGB8, 8);
+    const auto &gamma = GammaTable::Get();
+    int expected = gamma.ToSrgb(0.5F) * 255.F + 0.5F;
+    bool ok = mipmap.level_count() == 8 && mipmap.pixel(0) == stripes.data();
+    // sizes stop at 1 pixel, the last levels stay 1x1
+    int sizes[][2] = {{8, 4}, {4, 2}, {2, 1}, {1, 1}, {1, 1}};
+    for (int i = 0; i < 5; ++i) {
+        ok &= mipmap.width(i) == sizes[i][0];
+        ok &= mipmap.height(i) == sizes[i][1];
+    }
+    for (int i = 1; i < mipmap.level_count(); ++i) {
+        auto p = mipmap.pixel(i);
+        for (int j = 0; j < mipmap.width(i) * mipmap.height(i) * 3; ++j) {
+            ok &= std::abs(p[j] - expected) <= 1;
+        }
+    }
+    std::printf("stripes: level 1 is %d, expected %d\n", mipmap.pixel(1)[0],
+            expected);
+    return ok;
+}
+
+// mean of linear light of an 'RGB8' image
+float GetMean(const unsigned char *pixels, int width, int height) {
+    const auto &gamma = GammaTable::Get();
+    double sum = 0;
+    for (int i = 0; i < width * height * 3; ++i) {
+        sum += gamma.ToLinear(pixels[i]);
+    }
+    return sum / (width * height * 3);
+}
+
+// read the pixels of a binary PPM file
+bool ReadPpm(const std::string &path, int &width, int &height,
+        std::vector<unsigned char> &pixels) {
+    std::ifstream ifs(path, std::ios::binary);
+    std::string magic;
+    int max_value;
+    if (!(ifs >> magic >> width >> height >> max_value)) return false;
+    if (magic != "P6" || max_value != 255) return false;
+    ifs.get();
+    pixels.resize(width * height * 3);
+    ifs.read(reinterpret_cast<char *>(pixels.data()), pixels.size());
+    return static_cast<std::size_t>(ifs.gcount()) == pixels.size();
+}
+
+} // namespace
+
+// usage: mipmap [output directory]
+// check linear light filtering of mipmaps & the files written by
+// 'Canvas::ExportMipmaps', returns nonzero if any check fails
+int main(int argc, const char *argv[]) {
+    bool ok = CheckStripes();
+    // draw a scene with hard edges & gradients
+    Canvas canvas(320, 200);
+    canvas.set_backcolor(Color(SolidColor(0x102030), SolidColor(0xF0E0D0),
+            PI / 5));
+    auto sun = std::make_shared<Circle>(200, 90, 60);
+    sun->set_color(SolidColor(0xFFC040, 0.8F));
+    canvas.AddShape(sun);
+    auto bar = std::make_shared<Rectangle>(20, 140, 280, 12);
+    bar->set_color(SolidColor(0x101010));
+    canvas.AddShape(bar);
+    auto render = std::make_unique<BasicRender>();
+    render->set_anti_aliasing(true);
+    canvas.set_render(std::move(render));
+    canvas.set_image_container(std::make_unique<PpmContainer>(
+            PpmContainer::Format::PPM, true));
+    canvas.Redraw();
+    // export levels, then read them back
+    std::string dir = argc > 1 ? argv[1] : "out";
+    auto pattern = dir + "/mipmap_%d.ppm";
+    canvas.ExportMipmaps(pattern.c_str(), 4);
+    Mipmap mipmap;
+    mipmap.Build(canvas.pixel(), canvas.width(), canvas.height(),
+            PixelFormat::RGB8, 4);
+    auto mean = GetMean(canvas.pixel(), canvas.width(), canvas.height());
+    for (int i = 0; i < 4; ++i) {
+        auto path = dir + "/mipmap_" + std::to_string(mipmap.width(i))
+                + ".ppm";
+        int width = 0, height = 0;
+        std::vector<unsigned char> pixels;
+        auto read = ReadPpm(path, width, height, pixels);
+        auto same = read && width == mipmap.width(i)
+                && height == mipmap.height(i)
+                && std::equal(pixels.begin(), pixels.end(),
+                        mipmap.pixel(i));
+        // box filters keep the mean, up to quantization
+        auto level_mean = read ? GetMean(pixels.data(), width, height) : 0;
+        std::printf("%s: %dx%d, mean %.4f (level 0 %.4f), %s\n",
+                path.c_str(), width, height, level_mean, mean,
+                same ? "same as mipmap" : "different from mipmap");
+        ok &= same && std::abs(level_mean - mean) < 2e-3F;
+    }
+    return ok ? 0 : 1;
+}
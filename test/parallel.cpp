@@ -0,0 +1,74 @@
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "../src/render/parallel.h"
+#include "../src/render/verify.h"
+#include "../src/canvas.h"
+#include "../src/container/pngcont.h"
+#include "../src/util/mathutil.h"
+
+#include "../src/shape/rectangle.h"
+#include "../src/shape/operation.h"
+#include "../src/shape/circle.h"
+#include "../src/shape/layer.h"
+
+using namespace cvf;
+using namespace cvf::render;
+using namespace cvf::container;
+using namespace cvf::color;
+using namespace cvf::util;
+using namespace cvf::shape;
+
+// render with a parallel render, and check the result is the same
+// under several schedules, with & without high precision
+int main(int argc, const char *argv[]) {
+    Canvas canvas(640, 480);
+    canvas.set_backcolor(Color(SolidColor(0x203040), SolidColor(0xE0D0C0),
+            PI / 3));
+    // shapes with gradients, operations & a layer
+    ShapePtr card = std::make_shared<Rectangle>(80, 60, 480, 360);
+    card = std::make_shared<Operation>(Operation::Opcode::Round, card, 40);
+    card->set_color(Color(Color::ColorType::Radial, 0xFFFFFF, 0x5080C0,
+            0.F, 1.F, 0.F));
+    canvas.AddShape(card);
+    auto layer = std::make_shared<Layer>();
+    for (int i = 0; i < 5; ++i) {
+        auto dot = std::make_shared<Circle>(160 + i * 80, 240, 50);
+        dot->set_color(SolidColor(0xFF8000 + i * 0x20, 0.6F));
+        layer->AddShape(dot);
+    }
+    layer->set_opacity(0.8F);
+    canvas.AddShape(layer);
+    // verify schedules
+    ParallelRender render;
+    render.set_anti_aliasing(true);
+    ScheduleVerifier verifier;
+    verifier.AddSchedule(8, 3, ParallelRender::Schedule::Static);
+    for (auto high_precision : {false, true}) {
+        render.set_high_precision(high_precision);
+        auto ok = verifier.Verify(render, canvas.width(), canvas.height(),
+                PixelFormat::RGB8, canvas.backcolor(), canvas.shapes());
+        std::printf("high precision %s:", high_precision ? "on" : "off");
+        for (auto sum : verifier.checksums()) {
+            std::printf(" %016llx", static_cast<unsigned long long>(sum));
+        }
+        std::printf("\n");
+        if (!ok) {
+            std::printf("error: %s\n", verifier.error().c_str());
+            return 1;
+        }
+    }
+    // export, static bands are drawn by workers pinned to CPUs
+    auto parallel = std::make_unique<ParallelRender>();
+    parallel->set_anti_aliasing(true);
+    parallel->set_schedule(ParallelRender::Schedule::Static);
+    std::vector<int> cpus;
+    for (int i = 0; i < parallel->thread_count(); ++i) cpus.push_back(i);
+    parallel->set_affinity(cpus);
+    canvas.set_render(std::move(parallel));
+    canvas.set_image_container(std::make_unique<PngContainer>());
+    canvas.Redraw();
+    canvas.Export(argc > 1 ? argv[1] : "out/parallel.png");
+    return 0;
+}
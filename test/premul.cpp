@@ -0,0 +1,118 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <memory>
+
+#include "../src/render/basic.h"
+#include "../src/color/format.h"
+#include "../src/color/gamma.h"
+
+#include "../src/shape/circle.h"
+#include "../src/shape/rectangle.h"
+
+using namespace cvf;
+using namespace cvf::render;
+using namespace cvf::color;
+using namespace cvf::shape;
+
+namespace {
+
+constexpr int kWidth = 64, kHeight = 64;
+
+std::vector<unsigned char> Draw(BasicRender &render, PixelFormat format,
+        const ShapeList &shapes) {
+    std::vector<unsigned char> buffer(kWidth * kHeight * 4);
+    render.ReadBuffer(buffer.data(), kWidth, kHeight, format);
+    render.Redraw(SolidColor(0x000000, 0.F), shapes);
+    return buffer;
+}
+
+// premultiplied pixels must be straight pixels multiplied by alpha,
+// within the error of quantization
+bool Check(bool high_precision, const ShapeList &shapes) {
+    BasicRender render;
+    render.set_anti_aliasing(true);
+    render.set_high_precision(high_precision);
+    auto straight = Draw(render, PixelFormat::RGBA8, shapes);
+    auto premul = Draw(render, PixelFormat::PremulRGBA8, shapes);
+    int max_error = 0, partial = 0;
+    for (int i = 0; i < kWidth * kHeight * 4; i += 4) {
+        int alpha = straight[i + 3];
+        if (alpha > 0 && alpha < 255) ++partial;
+        max_error = std::max(max_error, std::abs(alpha - premul[i + 3]));
+        for (int c = 0; c < 3; ++c) {
+            int expected = (straight[i + c] * alpha + 127) / 255;
+            max_error = std::max(max_error,
+                    std::abs(expected - premul[i + c]));
+        }
+    }
+    // the center pixel is covered by the half transparent circle
+    auto center = ((kHeight / 2) * kWidth + kWidth / 2) * 4;
+    std::printf("high precision %s: center %d %d %d %d, "
+            "max error %d, partial pixels %d\n",
+            high_precision ? "on" : "off", premul[center],
+            premul[center + 1], premul[center + 2], premul[center + 3],
+            max_error, partial);
+    return max_error <= 2 && partial > 0;
+}
+
+// dithered shadows must average to the exact encoding of linear light,
+// which needs an encoding accurate well below a level of 8-bit
+bool CheckShadows() {
+    const auto &gamma = GammaTable::Get();
+    float table_error = 0;
+    for (int i = 0; i <= 1000; ++i) {
+        auto v = i * 0.02F / 1000;
+        table_error = std::fmax(table_error,
+                std::fabs(gamma.ToSrgb(v) - SrgbEncode(v)) * 255);
+    }
+    // half transparent dark bars over black
+    const int levels[] = {1, 2, 3, 5, 8, 13};
+    ShapeList shapes;
+    for (int i = 0; i < 6; ++i) {
+        auto bar = std::make_shared<Rectangle>(i * 10 + 2, 16, 8, 32);
+        auto v = static_cast<Color8b>(levels[i]);
+        bar->set_color(SolidColor(v, v, v, 0.5F));
+        shapes.push_back(bar);
+    }
+    BasicRender render;
+    render.set_anti_aliasing(true);
+    render.set_high_precision(true);
+    std::vector<unsigned char> buffer(kWidth * kHeight * 3);
+    render.ReadBuffer(buffer.data(), kWidth, kHeight, PixelFormat::RGB8);
+    render.Redraw(SolidColor(0, 0, 0), shapes);
+    // mean of whole cycles of dither inside each bar
+    float mean_error = 0;
+    for (int i = 0; i < 6; ++i) {
+        int sum = 0;
+        for (int y = 20; y < 44; ++y) {
+            for (int x = i * 10 + 4; x < i * 10 + 8; ++x) {
+                sum += buffer[(y * kWidth + x) * 3];
+            }
+        }
+        auto expected = SrgbEncode(0.5F * SrgbDecode(levels[i] / 255.F));
+        mean_error = std::fmax(mean_error,
+                std::fabs(sum / 96.F - expected * 255));
+    }
+    std::printf("shadows: encoding error %g, mean error %g levels\n",
+            table_error, mean_error);
+    return table_error < 0.02F && mean_error < 0.1F;
+}
+
+} // namespace
+
+// premultiplied output must match straight output at partial alpha,
+// returns nonzero if any pixel differs
+int main() {
+    auto circle = std::make_shared<Circle>(32, 32, 20);
+    circle->set_color(SolidColor(0xFF0000, 0.5F));
+    auto rect = std::make_shared<Rectangle>(8, 40, 48, 12);
+    rect->set_color(SolidColor(0x40C0FF, 0.3F));
+    ShapeList shapes = {circle, rect};
+    bool ok = true;
+    ok &= Check(false, shapes);
+    ok &= Check(true, shapes);
+    ok &= CheckShadows();
+    return ok ? 0 : 1;
+}
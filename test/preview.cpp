@@ -0,0 +1,121 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/render/basic.h"
+#include "../src/render/preview.h"
+#include "../src/canvas.h"
+#include "../src/container/asciicont.h"
+#include "../src/util/mathutil.h"
+
+#include "../src/shape/circle.h"
+#include "../src/shape/rectangle.h"
+#include "../src/shape/layer.h"
+
+using namespace cvf;
+using namespace cvf::render;
+using namespace cvf::container;
+using namespace cvf::color;
+using namespace cvf::util;
+using namespace cvf::shape;
+
+namespace {
+
+constexpr int kWidth = 480, kHeight = 240;
+
+int GetRampIndex(char c) {
+    return std::strchr(kAsciiRamp, c) - kAsciiRamp;
+}
+
+// characters of cells averaged from a full resolution render
+std::vector<std::string> GetReference(Canvas &canvas, int columns) {
+    canvas.Redraw();
+    float cell_w = static_cast<float>(kWidth) / columns, cell_h = cell_w * 2;
+    int rows = Max(static_cast<int>(kHeight / cell_h), 1);
+    std::vector<std::string> lines(rows, std::string(columns, ' '));
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < columns; ++col) {
+            int x0 = col * cell_w, x1 = (col + 1) * cell_w;
+            int y0 = row * cell_h, y1 = (row + 1) * cell_h;
+            int luma = 0, count = 0;
+            for (int y = y0; y < y1; ++y) {
+                for (int x = x0; x < x1; ++x, ++count) {
+                    auto p = canvas.pixel() + (y * kWidth + x) * 3;
+                    luma += GetLuma(p[0], p[1], p[2]);
+                }
+            }
+            lines[row][col] = GetASCII(luma / count);
+        }
+    }
+    return lines;
+}
+
+// compare preview with the reference, cells may differ by a few steps
+// of ramp, since the preview takes gradients at centers of cells
+bool Check(Canvas &canvas, int columns) {
+    std::ostringstream oss;
+    canvas.Preview(oss, columns);
+    auto reference = GetReference(canvas, columns);
+    std::istringstream iss(oss.str());
+    std::string line;
+    int rows = 0, max_diff = 0;
+    bool ok = true;
+    while (std::getline(iss, line)) {
+        if (rows >= static_cast<int>(reference.size())
+                || static_cast<int>(line.size()) != columns) {
+            ok = false;
+            break;
+        }
+        for (int col = 0; col < columns; ++col) {
+            auto diff = std::abs(GetRampIndex(line[col])
+                    - GetRampIndex(reference[rows][col]));
+            max_diff = Max(max_diff, diff);
+        }
+        ++rows;
+    }
+    std::printf("%d columns: %d of %zu rows, max difference %d\n", columns,
+            rows, reference.size(), max_diff);
+    if (columns == 60) std::printf("%s", oss.str().c_str());
+    return ok && rows == static_cast<int>(reference.size()) && max_diff <= 3;
+}
+
+} // namespace
+
+// check ASCII previews against cells averaged from a full render,
+// returns nonzero if their sizes differ or any cell is too far off
+int main() {
+    Canvas canvas(kWidth, kHeight);
+    canvas.set_backcolor(Color(SolidColor(0xFFFFFF), SolidColor(0x808080),
+            PI / 2));
+    auto board = std::make_shared<Rectangle>(40, 40, 160, 160);
+    board->set_color(SolidColor(0x202020));
+    canvas.AddShape(board);
+    auto moon = std::make_shared<Circle>(330, 110, 80);
+    moon->set_color(Color(Color::ColorType::Radial, 0x101010, 0xC0C0C0,
+            0.F, 1.F, 0.F));
+    canvas.AddShape(moon);
+    auto bar = std::make_shared<Rectangle>(20, 205, 440, 22);
+    bar->set_color(SolidColor(0x101010, 0.7F));
+    canvas.AddShape(bar);
+    // layers are drawn from their pre-rendered pixels
+    auto layer = std::make_shared<Layer>();
+    auto sign = std::make_shared<Rectangle>(60, 60, 130, 50);
+    sign->set_color(SolidColor(0xF0F0F0));
+    layer->AddShape(sign);
+    auto spot = std::make_shared<Circle>(250, 70, 40);
+    spot->set_color(SolidColor(0xE0E0E0, 0.9F));
+    layer->AddShape(spot);
+    layer->set_opacity(0.8F);
+    layer->set_offset(12, 8);
+    canvas.AddShape(layer);
+    auto render = std::make_unique<BasicRender>();
+    render->set_anti_aliasing(true);
+    canvas.set_render(std::move(render));
+    bool ok = true;
+    for (int columns : {24, 60, 120}) ok &= Check(canvas, columns);
+    return ok ? 0 : 1;
+}
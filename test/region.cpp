@@ -0,0 +1,154 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "../src/render/basic.h"
+#include "../src/canvas.h"
+#include "../src/util/mathutil.h"
+
+#include "../src/shape/circle.h"
+#include "../src/shape/rectangle.h"
+#include "../src/shape/operation.h"
+#include "../src/shape/layer.h"
+
+using namespace cvf;
+using namespace cvf::render;
+using namespace cvf::color;
+using namespace cvf::util;
+using namespace cvf::shape;
+
+namespace {
+
+constexpr int kWidth = 320, kHeight = 240;
+
+// maximum difference between a region & the same pixels of canvas
+int CompareCrop(const Canvas &canvas, const Rect &region,
+        const std::vector<unsigned char> &tile) {
+    int width = region.right - region.left + 1, max_diff = 0;
+    for (int y = region.top; y <= region.bottom; ++y) {
+        for (int x = region.left; x <= region.right; ++x) {
+            auto p = canvas.pixel() + (y * kWidth + x) * 3;
+            auto q = tile.data()
+                    + ((y - region.top) * width + x - region.left) * 3;
+            for (int c = 0; c < 3; ++c) {
+                max_diff = Max(max_diff, std::abs(p[c] - q[c]));
+            }
+        }
+    }
+    return max_diff;
+}
+
+std::vector<unsigned char> RenderRegion(Canvas &canvas, const Rect &region,
+        float scale) {
+    int width, height;
+    Canvas::GetRegionSize(region, scale, width, height);
+    std::vector<unsigned char> tile(width * height * 3);
+    canvas.RenderRegion(region, scale, tile.data());
+    return tile;
+}
+
+std::vector<unsigned char> GetImage(const Canvas &canvas) {
+    return std::vector<unsigned char>(canvas.pixel(),
+            canvas.pixel() + kWidth * kHeight * 3);
+}
+
+int MaxDifference(const std::vector<unsigned char> &a,
+        const std::vector<unsigned char> &b) {
+    int max_diff = 0;
+    for (std::size_t i = 0; i < a.size() && i < b.size(); ++i) {
+        max_diff = Max(max_diff, std::abs(a[i] - b[i]));
+    }
+    return max_diff;
+}
+
+// shapes of scene, those of the layer are drawn directly if 'flat'
+void AddShapes(Canvas &canvas, bool flat) {
+    canvas.set_backcolor(Color(SolidColor(0x203040), SolidColor(0xF0E0C0),
+            PI / 3));
+    ShapePtr card = std::make_shared<Rectangle>(40, 30, 200, 150);
+    card = std::make_shared<Operation>(Operation::Opcode::Round, card, 20);
+    card->set_color(Color(0x4080F0, 0xF04080U));
+    canvas.AddShape(card);
+    auto dot = std::make_shared<Circle>(230.5F, 160.3F, 55.7F);
+    dot->set_color(SolidColor(0xFFC040, 0.7F));
+    canvas.AddShape(dot);
+    ShapeList badge = {std::make_shared<Rectangle>(110, 110, 70, 30),
+            std::make_shared<Circle>(200, 70, 18)};
+    badge[0]->set_color(SolidColor(0x30C060));
+    badge[1]->set_color(SolidColor(0xE02030));
+    if (!flat) {
+        auto layer = std::make_shared<Layer>(badge);
+        layer->set_offset(6, -4);
+        canvas.AddShape(layer);
+        return;
+    }
+    for (const auto &shape : badge) {
+        ShapePtr moved = std::make_shared<Operation>(
+                Operation::Opcode::OffsetX, shape, 6);
+        moved = std::make_shared<Operation>(Operation::Opcode::OffsetY,
+                moved, -4);
+        moved->set_color(shape->color());
+        canvas.AddShape(moved);
+    }
+}
+
+void SetRender(Canvas &canvas) {
+    auto render = std::make_unique<BasicRender>();
+    render->set_anti_aliasing(true);
+    canvas.set_render(std::move(render));
+}
+
+} // namespace
+
+// check regions rendered by 'RenderRegion' against the whole canvas,
+// that layers are drawn in regions, & that cached tiles follow the
+// settings of render, returns nonzero if any check fails
+int main() {
+    Canvas canvas(kWidth, kHeight);
+    AddShapes(canvas, false);
+    auto render = std::make_unique<BasicRender>();
+    auto &settings = *render;
+    render->set_anti_aliasing(true);
+    canvas.set_render(std::move(render));
+    canvas.Redraw();
+    auto image = GetImage(canvas);
+    bool ok = true;
+    // the whole canvas at scale 1 is the image itself
+    Rect full(0, 0, kWidth - 1, kHeight - 1);
+    auto whole = RenderRegion(canvas, full, 1.F);
+    ok &= whole == image;
+    std::printf("full canvas: %s\n", whole == image ? "same" : "different");
+    // crops, cached ones are returned from the tile cache
+    Rect crop(100, 60, 259, 199);
+    for (int i = 0; i < 2; ++i) {
+        auto diff = CompareCrop(canvas, crop, RenderRegion(canvas, crop, 1));
+        std::printf("crop %s: max difference %d\n",
+                i ? "from cache" : "rendered", diff);
+        ok &= diff == 0;
+    }
+    // magnified region has the size of scale, the layer is drawn from
+    // its shapes like the same shapes drawn without a layer
+    int width, height;
+    Canvas::GetRegionSize(crop, 2.5F, width, height);
+    ok &= width == 400 && height == 350;
+    Canvas flat(kWidth, kHeight);
+    AddShapes(flat, true);
+    SetRender(flat);
+    auto diff = MaxDifference(RenderRegion(canvas, crop, 2.5F),
+            RenderRegion(flat, crop, 2.5F));
+    std::printf("magnified layer: max difference %d\n", diff);
+    ok &= diff <= 2;
+    // changed settings are not served from the tile cache
+    settings.set_anti_aliasing(false);
+    canvas.Redraw();
+    auto aliased = GetImage(canvas);
+    auto tile = RenderRegion(canvas, full, 1.F);
+    std::printf("anti-aliasing off: %s, full canvas %s\n",
+            aliased != image ? "changed" : "unchanged",
+            tile == aliased ? "same" : "different");
+    ok &= aliased != image && tile == aliased;
+    settings.set_anti_aliasing(true);
+    ok &= RenderRegion(canvas, full, 1.F) == image;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+#include <cstdio>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "../src/render/basic.h"
+#include "../src/color/color.h"
+#include "../src/color/format.h"
+#include "../src/util/mathutil.h"
+
+#include "../src/shape/circle.h"
+#include "../src/shape/rectangle.h"
+
+using namespace cvf;
+using namespace cvf::render;
+using namespace cvf::color;
+using namespace cvf::util;
+using namespace cvf::shape;
+
+namespace {
+
+constexpr int kWidth = 300, kHeight = 200;
+
+// a per-pixel function, written once & used in both kinds of colors
+SolidColor Plasma(float x, float y) {
+    auto v = std::sin(x * 9.F) + std::cos(y * 7.F) + std::sin((x + y) * 5.F);
+    auto t = (v + 3.F) / 6.F;
+    return SolidColor(ClampTo8b(t * 255.F), ClampTo8b(x * 255.F),
+            ClampTo8b((1.F - t) * 255.F), 0.5F + 0.5F * y);
+}
+
+bool IsSame(const SolidColor &a, const SolidColor &b) {
+    return a.red == b.red && a.green == b.green && a.blue == b.blue
+            && a.alpha == b.alpha;
+}
+
+// rows of both colors, with offsets & sizes of draw areas
+bool CheckRows(const Color &func, const Color &row_func) {
+    std::vector<SolidColor> a(64), b(64);
+    int differ = 0;
+    for (float width : {1.F, 37.F, 300.F}) {
+        for (float y = -2.F; y < 40.F; y += 3.5F) {
+            for (float x : {-5.F, 0.F, 12.5F}) {
+                func.GetColorRow(x, y, width, 41.F, a.size(), a.data());
+                row_func.GetColorRow(x, y, width, 41.F, b.size(),
+                        b.data());
+                for (std::size_t i = 0; i < a.size(); ++i) {
+                    differ += !IsSame(a[i], b[i]);
+                }
+            }
+        }
+    }
+    // single colors go through the row function with a row of one
+    for (float p = 0.F; p <= 1.F; p += 0.125F) {
+        differ += !IsSame(func.GetColor(p, 1.F - p),
+                row_func.GetColor(p, 1.F - p));
+    }
+    std::printf("rows: %d colors differ\n", differ);
+    return !differ;
+}
+
+std::vector<unsigned char> Draw(bool high_precision, const Color &color) {
+    ShapePtr rect = std::make_shared<Rectangle>(20, 20, 260, 160);
+    rect->set_color(color);
+    ShapePtr circle = std::make_shared<Circle>(150, 100, 70);
+    circle->set_color(color);
+    BasicRender render;
+    render.set_anti_aliasing(true);
+    render.set_high_precision(high_precision);
+    std::vector<unsigned char> buffer(kWidth * kHeight * 3);
+    render.ReadBuffer(buffer.data(), kWidth, kHeight, PixelFormat::RGB8);
+    render.Redraw(SolidColor(0x102030), {rect, circle});
+    return buffer;
+}
+
+} // namespace
+
+// check colors adapted by 'Color::MakeRowFunction' against the same
+// per-pixel function, returns nonzero if any color or pixel differs
+int main() {
+    Color func = Color::ColorFunction(Plasma);
+    Color row_func = Color::MakeRowFunction(Plasma);
+    bool ok = CheckRows(func, row_func);
+    for (auto high_precision : {false, true}) {
+        auto same = Draw(high_precision, func)
+                == Draw(high_precision, row_func);
+        std::printf("high precision %s: %s\n", high_precision ? "on" : "off",
+                same ? "same" : "different");
+        ok &= same;
+    }
+    return ok ? 0 : 1;
+}
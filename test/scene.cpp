@@ -0,0 +1,46 @@
+#include <cstdio>
+#include <cstring>
+
+#include "../src/render/basic.h"
+#include "../src/canvas.h"
+#include "../src/container/pngcont.h"
+#include "../src/scene/text.h"
+#include "../src/scene/loader.h"
+
+using namespace cvf;
+using namespace cvf::render;
+using namespace cvf::container;
+using namespace cvf::scene;
+
+// usage:
+//   scene <scene file> [output png]
+//   scene -c <text scene> <binary scene>
+int main(int argc, const char *argv[]) {
+    // compile text scene to binary scene
+    if (argc == 4 && !std::strcmp(argv[1], "-c")) {
+        SceneData data;
+        if (!data.ParseFile(argv[2])) {
+            std::fprintf(stderr, "%s: %s\n", argv[2], data.error().c_str());
+            return 1;
+        }
+        return data.SaveBinary(argv[3]) ? 0 : 1;
+    }
+    // load scene
+    SceneLoader loader;
+    auto path = argc > 1 ? argv[1] : "test/weather.scene";
+    if (!loader.LoadFile(path)) {
+        std::fprintf(stderr, "%s: %s\n", path, loader.error().c_str());
+        return 1;
+    }
+    // create canvas
+    auto render = std::make_unique<BasicRender>();
+    render->set_anti_aliasing(true);
+    Canvas canvas(loader.width(), loader.height());
+    loader.Apply(canvas);
+    canvas.set_render(std::move(render));
+    canvas.set_image_container(std::make_unique<PngContainer>());
+    // draw & export
+    canvas.Redraw();
+    canvas.Export(argc > 2 ? argv[2] : "out/scene.png");
+    return 0;
+}
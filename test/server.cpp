@@ -0,0 +1,118 @@
+#include <cstdio>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../src/server/server.h"
+#include "../src/server/client.h"
+#include "../src/render/basic.h"
+#include "../src/canvas.h"
+#include "../src/container/ppmcont.h"
+#include "../src/scene/loader.h"
+
+using namespace cvf;
+using namespace cvf::server;
+
+namespace {
+
+// render the scene in this process the way workers do, as binary PPM
+bool RenderDirect(const std::vector<char> &scene,
+        std::vector<unsigned char> &image) {
+    scene::SceneLoader loader;
+    if (!loader.LoadData(scene.data(), scene.size())) {
+        std::fprintf(stderr, "scene: %s\n", loader.error().c_str());
+        return false;
+    }
+    auto render = std::make_unique<render::BasicRender>();
+    render->set_anti_aliasing(true);
+    Canvas canvas(loader.width(), loader.height());
+    loader.Apply(canvas);
+    canvas.set_render(std::move(render));
+    canvas.set_image_container(std::make_unique<container::PpmContainer>(
+            container::PpmContainer::Format::PPM, true));
+    canvas.Redraw();
+    ByteBuffer buffer;
+    std::ostream os(&buffer);
+    canvas.Export(os);
+    os.flush();
+    image = buffer.bytes();
+    return true;
+}
+
+} // namespace
+
+// usage: server <scene file> [output png]
+// starts a render server, then renders the scene twice through a client,
+// the second request must reuse the cached shape trees & its image must
+// be the same as a direct render, & a huge canvas must be refused,
+// returns nonzero otherwise
+int main(int argc, const char *argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <scene file> [output png]\n",
+                argv[0]);
+        return 1;
+    }
+    auto socket_path = "/tmp/canvas-flat.sock";
+    // read scene
+    std::ifstream ifs(argv[1], std::ios::binary);
+    if (!ifs) {
+        std::fprintf(stderr, "failed to open %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<char> scene((std::istreambuf_iterator<char>(ifs)),
+            std::istreambuf_iterator<char>());
+    // start server
+    RenderServer server(2, 4);
+    if (!server.Start(socket_path)) {
+        std::fprintf(stderr, "server: %s\n", server.error().c_str());
+        return 1;
+    }
+    // send requests, PNG first & then PPM to compare pixels
+    RenderClient client;
+    if (!client.Connect(socket_path)) {
+        std::fprintf(stderr, "client: %s\n", client.error().c_str());
+        return 1;
+    }
+    std::vector<unsigned char> png, ppm;
+    for (auto format : {ImageFormat::PNG, ImageFormat::PPM}) {
+        auto &image = format == ImageFormat::PNG ? png : ppm;
+        auto begin = std::chrono::steady_clock::now();
+        if (!client.Render(scene.data(), scene.size(), format, image)) {
+            std::fprintf(stderr, "client: %s\n", client.error().c_str());
+            return 1;
+        }
+        std::chrono::duration<double, std::milli> time =
+                std::chrono::steady_clock::now() - begin;
+        std::printf("%s request: %zu bytes, %.2f ms\n",
+                format == ImageFormat::PNG ? "PNG" : "PPM", image.size(),
+                time.count());
+    }
+    auto hits = server.cache_hits(), misses = server.cache_misses();
+    std::printf("cache hits: %lld, misses: %lld\n", hits, misses);
+    // canvases too large are refused & the worker keeps serving
+    std::string huge = "canvas 65536 65536\n";
+    std::vector<unsigned char> refused, again;
+    auto rejected = !client.Render(huge.data(), huge.size(),
+            ImageFormat::PPM, refused);
+    rejected &= client.error() == "canvas is too large";
+    std::printf("huge canvas: %s\n", client.error().c_str());
+    rejected &= client.Render(scene.data(), scene.size(), ImageFormat::PPM,
+            again) && again == ppm;
+    client.Close();
+    server.Stop();
+    // compare with direct render
+    std::vector<unsigned char> direct;
+    if (!RenderDirect(scene, direct)) return 1;
+    auto same = !direct.empty() && ppm == direct;
+    std::printf("served image %s direct render\n",
+            same ? "is the same as" : "differs from");
+    // write the image
+    std::ofstream ofs(argc > 2 ? argv[2] : "out/server.png",
+            std::ios::binary);
+    ofs.write(reinterpret_cast<const char *>(png.data()), png.size());
+    return hits == 1 && misses == 1 && same && rejected ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "../src/render/basic.h"
+#include "../src/color/format.h"
+
+#include "../src/shape/rectangle.h"
+#include "../src/shape/circle.h"
+#include "../src/shape/operation.h"
+#include "../src/shape/shrinkwrap.h"
+
+using namespace cvf;
+using namespace cvf::render;
+using namespace cvf::color;
+using namespace cvf::shape;
+using Opcode = Operation::Opcode;
+
+namespace {
+
+constexpr int kWidth = 320, kHeight = 240;
+
+std::vector<unsigned char> Draw(BasicRender &render,
+        const ShapeList &shapes) {
+    std::vector<unsigned char> buffer(kWidth * kHeight * 3);
+    render.ReadBuffer(buffer.data(), kWidth, kHeight, PixelFormat::RGB8);
+    render.Redraw(SolidColor(0x203040), shapes);
+    return buffer;
+}
+
+// wrapped shapes must be drawn exactly like the shapes they wrap
+bool CheckSame(const ShapeList &shapes, const ShapeList &wrapped) {
+    bool ok = true;
+    for (auto exact_coverage : {false, true}) {
+        BasicRender render;
+        render.set_anti_aliasing(true);
+        render.set_exact_coverage(exact_coverage);
+        auto same = Draw(render, shapes) == Draw(render, wrapped);
+        std::printf("exact coverage %s: %s\n",
+                exact_coverage ? "on" : "off", same ? "same" : "different");
+        ok &= same;
+    }
+    return ok;
+}
+
+int GetArea(const Rect &rect) {
+    if (rect.right < rect.left || rect.bottom < rect.top) return 0;
+    return (rect.right - rect.left + 1) * (rect.bottom - rect.top + 1);
+}
+
+} // namespace
+
+// check shrink-wrapped shapes cover fewer pixels & are drawn the same,
+// returns nonzero if any check fails
+int main() {
+    // a thin frame, the difference keeps the area of the outer rectangle
+    ShapePtr outer = std::make_shared<Rectangle>(20, 20, 280, 200);
+    ShapePtr inner = std::make_shared<Rectangle>(28, 28, 264, 184);
+    ShapePtr frame = std::make_shared<Operation>(Opcode::Difference, outer,
+            inner);
+    frame->set_color(SolidColor(0xF0C040, 0.8F));
+    // only a small corner of the circle is left
+    ShapePtr disc = std::make_shared<Circle>(160, 120, 90);
+    ShapePtr cut = std::make_shared<Rectangle>(40, 20, 190, 200);
+    ShapePtr corner = std::make_shared<Operation>(Opcode::Difference, disc,
+            cut);
+    corner->set_color(SolidColor(0x40A0F0, 0.6F));
+    // nothing is left at all
+    ShapePtr hole = std::make_shared<Operation>(Opcode::Difference,
+            std::make_shared<Circle>(100, 100, 20),
+            std::make_shared<Circle>(100, 100, 40));
+    ShapeList shapes = {frame, corner, hole}, wrapped;
+    bool ok = true;
+    for (const auto &i : shapes) {
+        auto shape = std::make_shared<ShrinkWrappedShape>(i);
+        auto before = GetArea(i->GetDrawArea());
+        auto after = GetArea(shape->GetDrawArea());
+        std::printf("draw area: %d -> %d pixels\n", before, after);
+        ok &= after <= before;
+        wrapped.push_back(shape);
+    }
+    // the frame is not shrunk, the corner is, & the hole becomes empty
+    ok &= GetArea(wrapped[0]->GetDrawArea())
+            == GetArea(frame->GetDrawArea());
+    ok &= GetArea(wrapped[1]->GetDrawArea()) * 2
+            < GetArea(corner->GetDrawArea());
+    ok &= GetArea(wrapped[2]->GetDrawArea()) == 0;
+    ok &= CheckSame(shapes, wrapped);
+    return ok ? 0 : 1;
+}
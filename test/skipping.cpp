@@ -0,0 +1,87 @@
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "../src/render/basic.h"
+#include "../src/color/format.h"
+#include "../src/util/mathutil.h"
+
+#include "../src/shape/rectangle.h"
+#include "../src/shape/circle.h"
+#include "../src/shape/capsule.h"
+#include "../src/shape/operation.h"
+
+using namespace cvf;
+using namespace cvf::render;
+using namespace cvf::color;
+using namespace cvf::util;
+using namespace cvf::shape;
+
+namespace {
+
+constexpr int kWidth = 400, kHeight = 300;
+
+// count of pixels whose SDF is evaluated, from the profiler
+long long GetEvaluated(const BasicRender &render) {
+    long long evaluated = 0;
+    for (const auto &i : render.profiler().entries()) {
+        if (i.name != "background") evaluated += i.pixels_evaluated;
+    }
+    return evaluated;
+}
+
+// draw with & without distance skipping, returns false if any byte
+// differs or no pixel is skipped
+bool Check(bool anti_aliasing, bool exact_coverage, const ShapeList &shapes,
+        const Color &backcolor) {
+    BasicRender render;
+    render.set_anti_aliasing(anti_aliasing);
+    render.set_exact_coverage(exact_coverage);
+    render.set_profiling(true);
+    std::vector<unsigned char> normal(kWidth * kHeight * 3);
+    render.ReadBuffer(normal.data(), kWidth, kHeight, PixelFormat::RGB8);
+    render.Redraw(backcolor, shapes);
+    auto normal_evaluated = GetEvaluated(render);
+    std::vector<unsigned char> skipped(normal.size());
+    render.set_distance_skipping(true);
+    render.ReadBuffer(skipped.data(), kWidth, kHeight, PixelFormat::RGB8);
+    render.Redraw(backcolor, shapes);
+    auto skipped_evaluated = GetEvaluated(render);
+    auto same = normal == skipped;
+    std::printf("anti-aliasing %s, exact coverage %s: %s, "
+            "evaluated %lld -> %lld pixels\n", anti_aliasing ? "on" : "off",
+            exact_coverage ? "on" : "off", same ? "same" : "different",
+            normal_evaluated, skipped_evaluated);
+    return same && skipped_evaluated < normal_evaluated;
+}
+
+} // namespace
+
+// check distance skipping draws exactly the same pixels as the normal
+// render, returns nonzero if any pixel differs
+int main() {
+    Color backcolor(SolidColor(0x101820), SolidColor(0x405060), PI / 4);
+    ShapePtr card = std::make_shared<Rectangle>(30, 30, 220, 160);
+    card = std::make_shared<Operation>(Operation::Opcode::Round, card, 24);
+    card->set_color(Color(Color::ColorType::Radial, 0xFFFFFF, 0x4070B0,
+            0.F, 1.F, 0.F));
+    // sizes with fractional parts, so boundaries fall inside pixels
+    auto sun = std::make_shared<Circle>(280.3F, 110.6F, 70.25F);
+    sun->set_color(SolidColor(0xF0B030, 0.7F));
+    auto stroke = std::make_shared<Capsule>(40.5F, 250.2F, 360.7F, 200.4F,
+            9.6F);
+    stroke->set_color(Color(0xE04060, 0x60E0A0U));
+    ShapePtr ring = std::make_shared<Circle>(120.5F, 200.5F, 60.3F);
+    ring = std::make_shared<Operation>(Operation::Opcode::Outline, ring,
+            7.5F);
+    ring->set_color(SolidColor(0x80FF80, 0.5F));
+    // tiny shapes, narrower than a pixel
+    auto dot = std::make_shared<Circle>(350.7F, 40.2F, 0.4F);
+    auto hair = std::make_shared<Rectangle>(10.2F, 10.6F, 300.4F, 0.3F);
+    ShapeList shapes = {card, sun, stroke, ring, dot, hair};
+    bool ok = true;
+    ok &= Check(false, false, shapes, backcolor);
+    ok &= Check(true, false, shapes, backcolor);
+    ok &= Check(true, true, shapes, backcolor);
+    return ok ? 0 : 1;
+}
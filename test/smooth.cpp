@@ -0,0 +1,97 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "../src/render/basic.h"
+#include "../src/color/color.h"
+#include "../src/util/mathutil.h"
+
+#include "../src/shape/circle.h"
+#include "../src/shape/rectangle.h"
+#include "../src/shape/operation.h"
+#include "../src/shape/expr.h"
+
+using namespace cvf;
+using namespace cvf::render;
+using namespace cvf::color;
+using namespace cvf::util;
+using namespace cvf::shape;
+using Opcode = Operation::Opcode;
+
+namespace {
+
+constexpr int kWidth = 240, kHeight = 160;
+
+// the same SDF drawn over the whole canvas, so nothing is clipped
+// by the bounds of shape
+class Unbounded : public Shape {
+public:
+    Unbounded(ShapePtr shape) : shape_(shape) {}
+
+    float GetSDF(float x, float y) const override {
+        return shape_->GetSDF(x, y);
+    }
+    void GetSDFRow(float x, float y, int count, float *sdf) const override {
+        shape_->GetSDFRow(x, y, count, sdf);
+    }
+    Rect GetDrawArea() const override {
+        return Rect(0, 0, kWidth - 1, kHeight - 1);
+    }
+
+private:
+    ShapePtr shape_;
+};
+
+std::vector<unsigned char> Draw(const ShapePtr &shape) {
+    shape->set_color(SolidColor(0xF0C020));
+    BasicRender render;
+    render.set_anti_aliasing(true);
+    std::vector<unsigned char> buffer(kWidth * kHeight * 3);
+    render.ReadBuffer(buffer.data(), kWidth, kHeight, PixelFormat::RGB8);
+    render.Redraw(SolidColor(0x203040), {shape});
+    return buffer;
+}
+
+// maximum difference between a shape & the same shape unbounded
+bool Check(const char *name, const ShapePtr &shape) {
+    auto a = Draw(shape);
+    auto b = Draw(std::make_shared<Unbounded>(shape));
+    int max_diff = 0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        max_diff = Max(max_diff, std::abs(a[i] - b[i]));
+    }
+    std::printf("%s: max difference %d\n", name, max_diff);
+    return max_diff == 0;
+}
+
+ShapePtr MakeOp(Opcode opcode, ShapePtr a, ShapePtr b, float param) {
+    return std::make_shared<Operation>(opcode, a, b, param);
+}
+
+ShapePtr MakeOp(Opcode opcode, ShapePtr a, float param) {
+    return std::make_shared<Operation>(opcode, a, param);
+}
+
+} // namespace
+
+// check bounds of smooth unions against renders which are not clipped
+// by bounds, blurred operands are blended within the whole blend radius,
+// returns nonzero if any pixel differs
+int main() {
+    bool ok = true;
+    ShapePtr a = std::make_shared<Circle>(80, 80, 40);
+    ShapePtr b = std::make_shared<Rectangle>(130, 60, 60, 40);
+    ok &= Check("exact", MakeOp(Opcode::SmoothUnion, a, b, 16));
+    for (float radius : {0.5F, 6.F}) {
+        auto blurred = MakeOp(Opcode::Blur, a, radius);
+        auto name = radius < 1.F ? "blur 0.5" : "blur 6";
+        ok &= Check(name, MakeOp(Opcode::SmoothUnion, blurred, b, 8));
+    }
+    // expression templates share the bounds of 'Operation'
+    namespace e = expr;
+    auto blended = e::MakeSmoothUnion(e::MakeBlur(e::Circle(80, 80, 40), 6),
+            e::Rectangle(130, 60, 60, 40), 8);
+    ok &= Check("expression", e::MakeShape(blended));
+    return ok ? 0 : 1;
+}